@@ -0,0 +1,319 @@
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "bench.hpp"
+#include "named_fstream.hpp"
+#include "util.hpp"
+#include "messages/list.hpp"
+#include "pre-process/pre-processor.hpp"
+#include "assembler_data.hpp"
+#include "parser.hpp"
+
+namespace bench {
+  // generated sources live in memory, under this directory
+  const std::filesystem::path root = "/assembler_bench";
+
+  struct Options {
+    int labels = 1000;
+    int instructions = 20000;
+    int macros = 100;
+    int constants = 100;
+    int include_depth = 4; // length of the chain of %include-d files, which hold the macros and constants
+    std::vector<int> scales = {1, 2, 4}; // multiples of the above counts (except depth) to assemble
+    int repeats = 3;
+    std::filesystem::path output_path; // file to write JSON results to
+    std::unique_ptr<named_fstream> baseline_file; // JSON results to compare against
+    double threshold = 10.0; // percentage increase in ns/line which counts as a regression
+  };
+
+  // synthetic program: the main file, plus each %include-d file by path
+  struct Program {
+    std::string source;
+    std::map<std::filesystem::path, std::string> includes;
+    uint64_t lines = 0; // total source lines
+    uint64_t bytes = 0; // size of the assembled image
+  };
+
+  struct Result {
+    int scale;
+    uint64_t lines = 0;
+    double read_ms = 0, pre_process_ms = 0, parse_ms = 0, write_ms = 0; // best time of each phase
+    double lines_per_second = 0;
+    double ns_per_line = 0;
+    double peak_mib = 0; // peak resident memory of the process so far
+  };
+
+  // generate a program whose counts are those in `opts` multiplied by `scale`
+  Program generate(const Options &opts, int scale) {
+    Program program;
+    int labels = opts.labels * scale, instructions = opts.instructions * scale, macros = opts.macros * scale,
+        constants = opts.constants * scale;
+    std::mt19937 random(scale);
+
+    // macros and constants are spread over the chain of included files, or the main file if there are none
+    std::vector<std::ostringstream> files(opts.include_depth + 1);
+
+    for (int i = 0; i < opts.include_depth; i++) {
+      files[i] << "%include inc" << i << "\n";
+    }
+
+    for (int i = 0; i < constants; i++) {
+      files[opts.include_depth > 0 ? 1 + i % opts.include_depth : 0] << "%define C" << i << " " << i << "\n";
+    }
+
+    for (int i = 0; i < macros; i++) {
+      files[opts.include_depth > 0 ? 1 + i % opts.include_depth : 0]
+          << "%macro M" << i << " a b\n"
+          << "  add a, a, b\n"
+          << "  sub b, b, " << i << "\n"
+          << "%end\n";
+    }
+
+    // instructions, with a label every so often, cycling through constants, macros and label references
+    std::ostringstream &main = files[0];
+    int per_label = labels > 0 ? std::max(1, instructions / labels) : instructions + 1, label = 0;
+    main << "main:\n";
+    uint64_t emitted = 1; // instructions assembled, including the final exit
+
+    for (int i = 0; i < instructions; i++) {
+      emitted += i % 4 == 1 && macros > 0 ? 2 : 1;
+
+      if (label < labels && i % per_label == 0) main << "L" << label++ << ":\n";
+
+      switch (i % 4) {
+        case 0:
+          if (constants > 0) main << "  add $r1, $r1, C" << random() % constants << "\n";
+          else main << "  add $r1, $r1, " << i << "\n";
+          break;
+        case 1:
+          if (macros > 0) main << "  M" << random() % macros << " $r2, $r3\n";
+          else main << "  add $r2, $r2, $r3\n";
+          break;
+        case 2:
+          if (labels > 0) main << "  jal L" << random() % labels << "\n";
+          else main << "  nop\n";
+          break;
+        default:
+          main << "  load $r4, (0x" << std::hex << 8 * i << std::dec << ")\n";
+      }
+    }
+
+    while (label < labels) main << "L" << label++ << ":\n";
+    main << "  exit\n";
+    program.bytes = emitted * sizeof(uint64_t);
+
+    for (size_t i = 0; i < files.size(); i++) {
+      std::string text = files[i].str();
+      program.lines += std::count(text.begin(), text.end(), '\n');
+
+      if (i == 0) program.source = std::move(text);
+      else program.includes.insert({root / ("inc" + std::to_string(i - 1) + ".asm"), std::move(text)});
+    }
+
+    return program;
+  }
+
+  double elapsed_ms(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  }
+
+  double peak_mib() {
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return (double) usage.ru_maxrss / 1024; // kilobytes on Linux
+  }
+
+  // assemble the program, keeping the best time of each phase over several repeats
+  bool measure(const Options &opts, const Program &program, Result &result) {
+    assembler::CliArguments args;
+    args.lib_path = root;
+    args.include_resolver = [&program](const std::filesystem::path &path, std::string &contents) {
+      auto file = program.includes.find(path.lexically_normal());
+      if (file == program.includes.end()) return false;
+      contents = file->second;
+      return true;
+    };
+
+    result.lines = program.lines;
+    double best[4] = {-1, -1, -1, -1};
+
+    for (int i = 0; i < opts.repeats; i++) {
+      message::List messages;
+      double times[4];
+
+      auto start = std::chrono::steady_clock::now();
+      assembler::pre_processor::Data pre_data(args);
+      std::istringstream stream(program.source);
+      assembler::read_source(stream, root / "main.asm", pre_data);
+      times[0] = elapsed_ms(start);
+
+      start = std::chrono::steady_clock::now();
+      assembler::pre_process(pre_data, messages);
+      times[1] = elapsed_ms(start);
+      if (message::print_and_check(messages, std::cerr)) return false;
+
+      start = std::chrono::steady_clock::now();
+      assembler::Data data(pre_data);
+      assembler::parser::parse(data, messages);
+      times[2] = elapsed_ms(start);
+      if (message::print_and_check(messages, std::cerr)) return false;
+
+      // a mis-sized image would time the layout of a corrupted program
+      if (data.get_bytes() != program.bytes) {
+        std::cerr << "assembled " << data.get_bytes() << " bytes, expected " << program.bytes << std::endl;
+        return false;
+      }
+
+      start = std::chrono::steady_clock::now();
+      std::ostringstream output(std::ios::out | std::ios::binary);
+      data.write(output);
+      times[3] = elapsed_ms(start);
+
+      for (int phase = 0; phase < 4; phase++) {
+        if (best[phase] < 0 || times[phase] < best[phase]) best[phase] = times[phase];
+      }
+    }
+
+    result.read_ms = best[0];
+    result.pre_process_ms = best[1];
+    result.parse_ms = best[2];
+    result.write_ms = best[3];
+    double total_ms = best[0] + best[1] + best[2] + best[3];
+    result.ns_per_line = total_ms * 1e6 / (double) result.lines;
+    result.lines_per_second = (double) result.lines * 1e3 / total_ms;
+    result.peak_mib = peak_mib();
+    return true;
+  }
+
+  void write_json(std::ostream &os, const std::vector<Result> &results) {
+    os << "{" << std::endl << "  \"results\": [" << std::endl;
+
+    // one result per line -- see `read_baseline`
+    for (size_t i = 0; i < results.size(); i++) {
+      const Result &r = results[i];
+      os << "    {\"scale\": " << r.scale << ", \"lines\": " << r.lines << std::fixed << std::setprecision(3)
+         << ", \"read_ms\": " << r.read_ms << ", \"pre_process_ms\": " << r.pre_process_ms << ", \"parse_ms\": "
+         << r.parse_ms << ", \"write_ms\": " << r.write_ms << ", \"ns_per_line\": " << r.ns_per_line
+         << ", \"lines_per_second\": " << std::setprecision(0) << r.lines_per_second << ", \"peak_mib\": "
+         << std::setprecision(1) << r.peak_mib << "}" << (i + 1 < results.size() ? "," : "") << std::endl;
+      os << std::defaultfloat;
+    }
+
+    os << "  ]" << std::endl << "}" << std::endl;
+  }
+}
+
+int parse_arguments(int argc, char **argv, bench::Options &opts) {
+  for (int i = 1; i < argc; i++) {
+    std::string arg(argv[i]);
+
+    if (arg == "-n" || arg == "-m" || arg == "-k" || arg == "-c" || arg == "-d" || arg == "-s" || arg == "-r"
+        || arg == "-o" || arg == "--baseline" || arg == "--threshold") {
+      if (++i >= argc) {
+        std::cerr << arg << ": expected a value.";
+        return EXIT_FAILURE;
+      }
+
+      if (arg == "-n") {
+        opts.labels = std::max(0, std::atoi(argv[i]));
+      } else if (arg == "-m") {
+        opts.instructions = std::max(0, std::atoi(argv[i]));
+      } else if (arg == "-k") {
+        opts.macros = std::max(0, std::atoi(argv[i]));
+      } else if (arg == "-c") {
+        opts.constants = std::max(0, std::atoi(argv[i]));
+      } else if (arg == "-d") {
+        opts.include_depth = std::max(0, std::atoi(argv[i]));
+      } else if (arg == "-s") {
+        opts.scales.clear();
+        split_string(argv[i], ',', [&opts](const std::string &s) {
+          opts.scales.push_back(std::max(1, std::atoi(s.c_str())));
+        });
+      } else if (arg == "-r") {
+        opts.repeats = std::max(1, std::atoi(argv[i]));
+      } else if (arg == "-o") {
+        opts.output_path = argv[i];
+      } else if (arg == "--baseline") {
+        if (!(opts.baseline_file = named_fstream::open(argv[i], std::ios::in))) {
+          std::cerr << arg << ": failed to open file '" << argv[i] << "'";
+          return EXIT_FAILURE;
+        }
+      } else {
+        opts.threshold = std::atof(argv[i]);
+      }
+
+      continue;
+    }
+
+    std::cerr << "unknown argument " << arg;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+int main(int argc, char **argv) {
+  bench::Options opts;
+
+  if (parse_arguments(argc, argv, opts) != EXIT_SUCCESS) {
+    return EXIT_FAILURE;
+  }
+
+  // read the baseline now, as it may be the same file as the output
+  std::map<std::string, double> baseline;
+  if (opts.baseline_file) baseline = bench::read_baseline(opts.baseline_file->stream, {"scale"}, "ns_per_line");
+  opts.baseline_file = nullptr;
+
+  // peak memory only grows, so assemble the smallest programs first
+  std::sort(opts.scales.begin(), opts.scales.end());
+
+  std::vector<bench::Result> results;
+  std::cout << std::left << std::setw(8) << "scale" << std::right << std::setw(10) << "lines" << std::setw(10)
+            << "read ms" << std::setw(10) << "pre ms" << std::setw(10) << "parse ms" << std::setw(10) << "write ms"
+            << std::setw(12) << "lines/s" << std::setw(10) << "peak MiB" << std::endl;
+
+  for (int scale : opts.scales) {
+    bench::Program program = bench::generate(opts, scale);
+    bench::Result result{scale};
+    if (!bench::measure(opts, program, result)) return EXIT_FAILURE;
+
+    std::cout << "x" << std::left << std::setw(7) << result.scale << std::right << std::setw(10) << result.lines
+              << std::fixed << std::setprecision(2) << std::setw(10) << result.read_ms << std::setw(10)
+              << result.pre_process_ms << std::setw(10) << result.parse_ms << std::setw(10) << result.write_ms
+              << std::setprecision(0) << std::setw(12) << result.lines_per_second << std::setprecision(1)
+              << std::setw(10) << result.peak_mib << std::defaultfloat << std::endl;
+    results.push_back(result);
+  }
+
+  if (!opts.output_path.empty()) {
+    auto file = named_fstream::open(opts.output_path, std::ios::out);
+    if (!file) {
+      std::cerr << "-o: failed to open file " << opts.output_path;
+      return EXIT_FAILURE;
+    }
+
+    bench::write_json(file->stream, results);
+    std::cout << "results written to " << file->path << std::endl;
+  }
+
+  std::vector<bench::Measurement> measurements;
+  for (const bench::Result &r : results) {
+    measurements.push_back({std::to_string(r.scale), "x" + std::to_string(r.scale), r.ns_per_line});
+  }
+
+  if (!baseline.empty() && bench::compare(measurements, baseline, opts.threshold) > 0) {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,99 @@
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include "linker.hpp"
+
+/** Read an object file, adding it to the list of inputs. */
+int read_object(const char *path, bool library, std::vector<assembler::linker::Input> &inputs) {
+  std::ifstream file(path, std::ios::in | std::ios::binary);
+
+  if (!file.is_open()) {
+    std::cout << "failed to open file " << path << "\n";
+    return EXIT_FAILURE;
+  }
+
+  assembler::linker::Input input{path, {}, library};
+
+  if (!input.object.read(file)) {
+    std::cout << path << ": not a valid object file\n";
+    return EXIT_FAILURE;
+  }
+
+  inputs.push_back(std::move(input));
+  return EXIT_SUCCESS;
+}
+
+int main(int argc, char **argv) {
+  std::vector<assembler::linker::Input> inputs;
+  const char *output_path = nullptr;
+  bool debug = false;
+
+  // Parse CLI
+  for (int i = 1; i < argc; ++i) {
+    if (argv[i][0] == '-') {
+      if (argv[i][1] == 'd' && !debug) {
+        // Enable debug mode
+        debug = true;
+      } else if (argv[i][1] == 'o' && !output_path) {
+        // Provide output file
+        if (++i == argc) {
+          std::cout << "-o: expected file path\n";
+          return EXIT_FAILURE;
+        }
+
+        output_path = argv[i];
+      } else if (argv[i][1] == 'l') {
+        // Provide library object
+        if (++i == argc) {
+          std::cout << "-l: expected file path\n";
+          return EXIT_FAILURE;
+        }
+
+        if (read_object(argv[i], true, inputs) == EXIT_FAILURE) {
+          return EXIT_FAILURE;
+        }
+      } else {
+        std::cout << "Unknown/repeated flag " << argv[i] << "\n";
+        return EXIT_FAILURE;
+      }
+    } else if (read_object(argv[i], false, inputs) == EXIT_FAILURE) {
+      return EXIT_FAILURE;
+    }
+  }
+
+  if (inputs.empty()) {
+    std::cout << "Expected input file to be provided\n";
+    return EXIT_FAILURE;
+  }
+
+  if (!output_path) {
+    std::cout << "Expected output file to be provided (-o <file>)\n";
+    return EXIT_FAILURE;
+  }
+
+  // Link objects in memory, so nothing is written on error
+  std::ostringstream stream;
+  message::List messages;
+  assembler::linker::link(inputs, stream, messages, debug);
+
+  if (message::print_and_check(messages, std::cerr)) {
+    return EXIT_FAILURE;
+  }
+
+  std::ofstream output(output_path, std::ios::out | std::ios::binary);
+
+  if (!output.is_open()) {
+    std::cout << "-o: failed to open file " << output_path << "\n";
+    return EXIT_FAILURE;
+  }
+
+  output << stream.str();
+
+  if (debug)
+    std::cout << "Written " << stream.str().size() << " bytes to file " << output_path << "\n";
+
+  return EXIT_SUCCESS;
+}
@@ -2,12 +2,15 @@
 #include <string>
 #include <iostream>
 #include <cstring>
+#include <atomic>
+#include <thread>
 
 #include "assembler/src/cli_arguments.hpp"
 #include "src/pre-process/pre-processor.hpp"
 #include "messages/list.hpp"
 #include "assembler_data.hpp"
 #include "parser.hpp"
+#include "linker.hpp"
 
 /** Parse command-line arguments. */
 int parse_arguments(int argc, char **argv, assembler::CliArguments &opts) {
@@ -57,12 +60,52 @@ int parse_arguments(int argc, char **argv, assembler::CliArguments &opts) {
           std::cout << "-r: failed to open file " << argv[i];
           return EXIT_FAILURE;
         }
+      } else if (argv[i][1] == 'g' && !opts.line_table_file) {
+        // Provide file to write line table to
+        if (++i >= argc) {
+          std::cout << "-g: expected file path\n";
+          return EXIT_FAILURE;
+        }
+
+        if (auto stream = named_fstream::open(argv[i], std::ios::out | std::ios::binary)) {
+          opts.line_table_file = std::move(stream);
+        } else {
+          std::cout << "-g: failed to open file " << argv[i];
+          return EXIT_FAILURE;
+        }
+      } else if (argv[i][1] == 'm' && !opts.symbol_map_file) {
+        // Provide file to write symbol map to
+        if (++i >= argc) {
+          std::cout << "-m: expected file path\n";
+          return EXIT_FAILURE;
+        }
+
+        if (auto stream = named_fstream::open(argv[i], std::ios::out)) {
+          opts.symbol_map_file = std::move(stream);
+        } else {
+          std::cout << "-m: failed to open file " << argv[i];
+          return EXIT_FAILURE;
+        }
+      } else if (argv[i][1] == 'O' && !opts.optimise) {
+        // Remove dead code and run peephole optimiser
+        opts.optimise = true;
+      } else if (argv[i][1] == 'c' && !opts.relocatable) {
+        // Emit relocatable object
+        opts.relocatable = true;
       } else if (argv[i][1] == 'l') {
         // Provide library path
         lib_path_suffix = ++i < argc ? argv[i] : "";
       } else if (opts.do_pre_processing && strcmp(argv[i] + 1, "-no-pre-process") == 0) {
         // Skip pre-processing
         opts.do_pre_processing = false;
+      } else if (opts.cache_path.empty() && strcmp(argv[i] + 1, "-cache") == 0) {
+        // Cache pre-processed %include-d files
+        if (++i == argc) {
+          std::cout << "--cache: expected directory path\n";
+          return EXIT_FAILURE;
+        }
+
+        opts.cache_path = argv[i];
       } else if (opts.do_compilation && strcmp(argv[i] + 1, "-no-compile") == 0) {
         // Skip compilation
         opts.do_compilation = false;
@@ -70,15 +113,14 @@ int parse_arguments(int argc, char **argv, assembler::CliArguments &opts) {
         std::cout << "Unknown/repeated flag " << argv[i] << "\n";
         return EXIT_FAILURE;
       }
-    } else if (!opts.source) {
-      if (auto stream = named_fstream::open(argv[i], std::ios::in)) {
+    } else if (auto stream = named_fstream::open(argv[i], std::ios::in)) {
+      if (!opts.source) {
         opts.source = std::move(stream);
       } else {
-        std::cout << "positional #" << i << ": failed to open file " << argv[i];
-        return EXIT_FAILURE;
+        opts.linked_sources.push_back(std::move(stream));
       }
     } else {
-      std::cout << "Unexpected argument '" << argv[i] << "'\n";
+      std::cout << "positional #" << i << ": failed to open file " << argv[i];
       return EXIT_FAILURE;
     }
   }
@@ -89,6 +131,13 @@ int parse_arguments(int argc, char **argv, assembler::CliArguments &opts) {
     return EXIT_FAILURE;
   }
 
+  if (!opts.linked_sources.empty() &&
+      (opts.relocatable || opts.post_processing_file || opts.reconstructed_asm_file || opts.line_table_file ||
+       opts.symbol_map_file)) {
+    std::cout << "-c, -g, -m, -p and -r expect a single input file\n";
+    return EXIT_FAILURE;
+  }
+
   if (!opts.output_file && opts.do_compilation) {
     std::cout << "Expected output file to be provided (-o <file>)\n";
     return EXIT_FAILURE;
@@ -188,19 +237,146 @@ int compile_result(assembler::Data &data) {
     std::cout << ANSI_GREEN "=== COMPILATION ===\n" ANSI_RESET;
 
     for (const auto &chunk: data.buffer) {
-      chunk->debug_print(std::cout);
+      data.buffer.debug_print(chunk, std::cout);
     }
   }
 
   // Write compiled chunks to output file
   auto &handle = *data.cli_args.output_file;
   auto before = handle.stream.tellp();
-  data.write(handle.stream);
+  if (data.cli_args.relocatable) {
+    message::List messages;
+    auto object = data.to_object(messages);
+
+    if (message::print_and_check(messages, std::cerr))
+      return EXIT_FAILURE;
+
+    object.write(handle.stream);
+  } else {
+    data.write(handle.stream);
+  }
   auto after = handle.stream.tellp();
 
   if (data.cli_args.debug)
     std::cout << "Written " << after - before + 1 << " bytes to file " << handle.path << "\n";
 
+  // Write line table?
+  if (auto &file = data.cli_args.line_table_file) {
+    data.write_line_table(file->stream);
+
+    if (data.cli_args.debug)
+      std::cout << "Written line table to " << file->path << "\n";
+  }
+
+  // Write symbol map?
+  if (auto &file = data.cli_args.symbol_map_file) {
+    data.write_symbol_map(file->stream, file->path.extension() == ".json");
+
+    if (data.cli_args.debug)
+      std::cout << "Written symbol map to " << file->path << "\n";
+  }
+
+  return EXIT_SUCCESS;
+}
+
+/** Pre-process and parse the source given in args, producing a relocatable object. Return success. */
+bool assemble_object(assembler::CliArguments &args, const char *executable, assembler::object::Object &object,
+                     message::List &messages) {
+  assembler::pre_processor::Data pre_data(args);
+  pre_data.set_executable(executable);
+  assembler::read_source_file(pre_data, messages);
+
+  if (messages.has_message_of(message::Error))
+    return false;
+
+  if (args.do_pre_processing) {
+    assembler::pre_process(pre_data, messages);
+
+    if (messages.has_message_of(message::Error))
+      return false;
+  }
+
+  assembler::Data data(pre_data);
+  assembler::parser::parse(data, messages);
+
+  if (messages.has_message_of(message::Error))
+    return false;
+
+  object = data.to_object(messages);
+  return !messages.has_message_of(message::Error);
+}
+
+/** Assemble each source on a pool of threads, then link the resulting objects in order. */
+int assemble_and_link(assembler::CliArguments &opts, const char *executable) {
+  // each source is assembled on its own, so give each its own arguments
+  std::vector<assembler::CliArguments> file_args(opts.linked_sources.size() + 1);
+  file_args[0].source = std::move(opts.source);
+
+  for (size_t i = 0; i < opts.linked_sources.size(); i++) {
+    file_args[i + 1].source = std::move(opts.linked_sources[i]);
+  }
+
+  for (auto &args: file_args) {
+    args.lib_path = opts.lib_path;
+    args.cache_path = opts.cache_path;
+    args.debug = opts.debug;
+    args.do_pre_processing = opts.do_pre_processing;
+    args.optimise = opts.optimise;
+    args.relocatable = true;
+  }
+
+  std::vector<assembler::linker::Input> inputs(file_args.size());
+  std::vector<message::List> messages(file_args.size());
+  std::vector<char> success(file_args.size());
+  std::atomic<size_t> next = 0;
+
+  auto worker = [&]() {
+    for (size_t i; (i = next++) < file_args.size();) {
+      inputs[i].path = file_args[i].source->path;
+      success[i] = assemble_object(file_args[i], executable, inputs[i].object, messages[i]);
+    }
+  };
+
+  // debug output is not synchronised, so assemble serially
+  size_t thread_count = opts.debug ? 1 : std::min<size_t>(file_args.size(), std::max(1u, std::thread::hardware_concurrency()));
+  std::vector<std::thread> threads;
+
+  for (size_t i = 1; i < thread_count; i++) {
+    threads.emplace_back(worker);
+  }
+
+  worker();
+
+  for (auto &thread: threads) {
+    thread.join();
+  }
+
+  // report messages in order of the sources
+  bool failed = false;
+
+  for (size_t i = 0; i < file_args.size(); i++) {
+    failed |= message::print_and_check(messages[i], std::cerr) || !success[i];
+  }
+
+  if (failed || !opts.do_compilation)
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+
+  if (opts.debug)
+    std::cout << ANSI_GREEN "=== LINKING ===\n" ANSI_RESET;
+
+  message::List link_messages;
+  auto &handle = *opts.output_file;
+  auto before = handle.stream.tellp();
+  assembler::linker::link(inputs, handle.stream, link_messages, opts.debug);
+
+  if (message::print_and_check(link_messages, std::cerr))
+    return EXIT_FAILURE;
+
+  auto after = handle.stream.tellp();
+
+  if (opts.debug)
+    std::cout << "Written " << after - before + 1 << " bytes to file " << handle.path << "\n";
+
   return EXIT_SUCCESS;
 }
 
@@ -212,6 +388,11 @@ int main(int argc, char **argv) {
     return EXIT_FAILURE;
   }
 
+  // Multiple sources are assembled separately, then linked
+  if (!opts.linked_sources.empty()) {
+    return assemble_and_link(opts, argv[0]);
+  }
+
   // Set-up pre-processing data
   assembler::pre_processor::Data pre_data(opts);
   pre_data.set_executable(argv[0]);
@@ -0,0 +1,53 @@
+#include "assemble.hpp"
+
+#include <sstream>
+
+#include "assembler_data.hpp"
+#include "parser.hpp"
+#include "pre-process/pre-processor.hpp"
+
+namespace assembler {
+  Assembly assemble(std::string_view source, const std::filesystem::path &path, const AssembleOptions &options,
+                    IncludeResolver resolver) {
+    Assembly result;
+
+    CliArguments args;
+    args.lib_path = options.lib_path;
+    args.include_resolver = std::move(resolver);
+    args.do_pre_processing = options.pre_process;
+    args.optimise = options.optimise;
+    args.relocatable = options.relocatable;
+
+    // Read source into lines
+    pre_processor::Data pre_data(args);
+    std::istringstream stream{std::string(source)};
+    read_source(stream, path, pre_data);
+
+    // Pre-process source
+    if (options.pre_process) {
+      pre_process(pre_data, result.messages);
+      if (result.messages.has_message_of(message::Error)) return result;
+    }
+
+    // Parse pre-processed lines
+    Data data(pre_data);
+    parser::parse(data, result.messages);
+    if (result.messages.has_message_of(message::Error)) return result;
+
+    // Write output
+    if (options.relocatable) {
+      std::ostringstream object(std::ios::out | std::ios::binary);
+      object::Object relocatable = data.to_object(result.messages);
+      if (result.messages.has_message_of(message::Error)) return result;
+
+      relocatable.write(object);
+      const std::string bytes = object.str();
+      result.image.assign(bytes.begin(), bytes.end());
+    } else {
+      result.image = data.image();
+    }
+
+    result.success = true;
+    return result;
+  }
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "messages/list.hpp"
+
+/**
+ * Entry point for assembling in memory, without the command-line driver. Nothing is read from or written to disk,
+ * except %include-d files when no resolver is given, and no output is printed.
+ */
+namespace assembler {
+  /** Read the contents of an %include-d file into the string, return false if it cannot be read. */
+  typedef std::function<bool(const std::filesystem::path &path, std::string &contents)> IncludeResolver;
+
+  struct AssembleOptions {
+    std::filesystem::path lib_path; // directory "lib:" includes are resolved against, need not exist with a resolver
+    bool pre_process = true;
+    bool optimise = false; // remove dead code and run the peephole optimiser
+    bool relocatable = false; // emit a relocatable object instead of a binary
+  };
+
+  struct Assembly {
+    bool success = false;
+    std::vector<uint8_t> image; // binary or relocatable object, as written to file by the assembler
+    message::List messages; // diagnostics, in the order they were raised
+  };
+
+  /**
+   * Assemble the given source, which is named `path` in diagnostics and relative includes. Included files are read
+   * through `resolver` if given, else from disk.
+   */
+  Assembly assemble(std::string_view source, const std::filesystem::path &path, const AssembleOptions &options,
+                    IncludeResolver resolver = nullptr);
+}
@@ -2,30 +2,231 @@
 #include "instructions/signature.hpp"
 
 #include "constants.hpp"
+#include "line_table.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <numeric>
+#include <sstream>
 
 namespace assembler {
-  void Data::replace_label(const std::string &label, uint32_t address) const {
-    for (const auto &chunk: buffer) {
-      chunk->replace_label(label, address, cli_args.debug);
+  void Data::advance(uint32_t line, uint64_t size) {
+    if (offset + size > UINT32_MAX && overflow_line < 0) overflow_line = line;
+    offset += size;
+  }
+
+  uint32_t Data::add_instruction(uint32_t line, instruction::Instruction instruction) {
+    place_labels();
+    uint32_t index = buffer.add_instruction(line, offset, std::move(instruction));
+    advance(line, sizeof(uint64_t));
+    return index;
+  }
+
+  void Data::add_data(uint32_t line, int column, const std::vector<uint8_t> &bytes) {
+    place_labels();
+    buffer.add_data(line, column, offset, bytes);
+    advance(line, bytes.size());
+  }
+
+  void Data::add_space(uint32_t line, int column, uint32_t size) {
+    place_labels();
+    buffer.add_space(line, column, offset, size);
+    advance(line, size);
+  }
+
+  uint32_t Data::align(uint32_t line, int column, uint32_t alignment) {
+    this->alignment = std::lcm(this->alignment, alignment);
+    uint32_t padding = (alignment - offset % alignment) % alignment;
+    if (padding == 0) return 0;
+
+    // the padding belongs to whatever precedes it
+    buffer.add_space(line, column, offset, padding);
+    advance(line, padding);
+
+    for (const std::string &name: pending_labels) {
+      labels.find(name)->second.addr = offset;
     }
+
+    return padding;
   }
 
-  uint32_t Data::get_bytes() const {
-    if (buffer.empty())
-      return 0;
+  void Data::unalign(uint32_t padding, uint32_t extent) {
+    buffer.pop_back(extent);
+    offset -= padding;
+  }
+
+  void Data::place_labels() {
+    for (const std::string &name: pending_labels) {
+      resolve_label(name, labels.find(name)->second.addr);
+    }
+
+    pending_labels.clear();
+  }
+
+  Location Data::location(const Chunk &chunk) const {
+    return lines[chunk.line].first.copy().column(chunk.column);
+  }
+
+  const std::string *Data::intern(const std::string &label) {
+    return &*label_names.insert(label).first;
+  }
+
+  void Data::resolve_references(uint32_t index) {
+    auto &instruction = buffer.instruction(index);
+    uint32_t chunk_offset = buffer.back().offset, line = buffer.back().line;
+
+    for (uint8_t i = 0; i < instruction.args.size(); i++) {
+      if (!instruction.args[i].is_label()) continue;
+
+      const std::string *label = instruction.args[i].get_label()->label;
+
+      if (cli_args.relocatable || cli_args.optimise) {
+        references.push_back({*label, instruction.args[i].get_label()->offset, chunk_offset, index, i, line});
+      }
+
+      if (auto it = labels.find(*label); it != labels.end()) {
+        instruction.resolve_label(i, it->second.addr, cli_args.debug);
+      } else {
+        fixups[label].push_back({index, i});
+      }
+    }
+  }
+
+  void Data::resolve_label(const std::string &label, uint32_t address) {
+    // a label which was never referenced has not been interned
+    auto name = label_names.find(label);
+    if (name == label_names.end()) return;
+
+    auto it = fixups.find(&*name);
+    if (it == fixups.end()) return;
+
+    for (const Fixup &fixup: it->second) {
+      buffer.instruction(fixup.instruction).resolve_label(fixup.arg, address, cli_args.debug);
+    }
+
+    fixups.erase(it);
+  }
+
+  bool Data::is_movable() const {
+    auto origin = origins.begin();
+    uint32_t end = 0; // end of the previous chunk
+
+    for (const Chunk &chunk: buffer) {
+      for (; origin != origins.end() && *origin <= chunk.offset; origin++) {
+        if (*origin < end) return false;
+      }
+
+      if (chunk.offset < end) return false;
+      end = chunk.offset + chunk.size;
+    }
+
+    for (; origin != origins.end(); origin++) {
+      if (*origin < end) return false;
+      end = *origin;
+    }
+
+    return true;
+  }
+
+  void Data::remove_chunks(const std::vector<bool> &removed, const std::vector<bool> &touched) {
+    // (offset, shift): offsets from `offset` onwards are moved down by `shift`
+    std::vector<std::pair<uint32_t, uint32_t>> shifts;
+    std::vector<std::pair<uint32_t, uint32_t>> removed_ranges; // [start, end) of each removed chunk
+    auto origin = origins.begin();
+    uint32_t shift = 0;
+
+    for (size_t i = 0; i < buffer.size(); i++) {
+      const Chunk &chunk = buffer[i];
+
+      // a .org fixes the offset of what follows
+      for (; origin != origins.end() && *origin <= chunk.offset; origin++) {
+        shift = 0;
+        shifts.emplace_back(*origin, 0);
+      }
+
+      if (removed[i]) {
+        // keep following chunks aligned, leaving a gap if need be
+        shift += chunk.size;
+        shifts.emplace_back(chunk.offset + chunk.size, shift - shift % alignment);
+        removed_ranges.emplace_back(chunk.offset, chunk.offset + chunk.size);
+      }
+    }
+
+    auto relocate = [&shifts](uint64_t offset) -> uint64_t {
+      auto it = std::upper_bound(shifts.begin(), shifts.end(), offset, [](uint64_t offset, const auto &entry) {
+        return offset < entry.first;
+      });
 
-    const auto &last = buffer.back();
-    return last->offset + last->size();
+      return it == shifts.begin() ? offset : offset - std::prev(it)->second;
+    };
+
+    // drop references from touched instructions, and from fields of removed data
+    std::erase_if(references, [&](const Reference &reference) {
+      if (reference.instruction >= 0) return bool(touched[reference.instruction]);
+
+      auto range = std::upper_bound(removed_ranges.begin(), removed_ranges.end(), reference.offset,
+                                    [](uint32_t offset, const auto &range) {
+                                      return offset < range.first;
+                                    });
+      return range != removed_ranges.begin() && reference.offset < std::prev(range)->second;
+    });
+
+    for (size_t i = 0; i < buffer.size(); i++) {
+      buffer[i].offset = relocate(buffer[i].offset);
+    }
+
+    buffer.erase(removed);
+    offset = relocate(offset);
+
+    for (auto &[name, label]: labels) {
+      label.addr = relocate(label.addr);
+    }
+
+    // patch references with the labels' new addresses, undeclared labels are left for the linker
+    for (Reference &reference: references) {
+      reference.offset = relocate(reference.offset);
+
+      auto label = labels.find(reference.label);
+      if (label == labels.end()) continue;
+
+      if (reference.instruction >= 0) {
+        buffer.instruction(reference.instruction).resolve_label(reference.arg, label->second.addr);
+        continue;
+      }
+
+      // find the data chunk containing the field
+      auto chunk = std::prev(std::upper_bound(buffer.begin(), buffer.end(), reference.offset,
+                                              [](uint32_t offset, const Chunk &chunk) {
+                                                return offset < chunk.offset;
+                                              }));
+      uint8_t *field = buffer.bytes(*chunk) + (reference.offset - chunk->offset);
+      uint64_t value = label->second.addr + reference.addend;
+
+      for (uint8_t i = 0; i < reference.arg; i++) {
+        field[i] = (value >> (8 * i)) & 0xff;
+      }
+    }
+  }
+
+  uint32_t Data::get_bytes() const {
+    return buffer.extent();
   }
 
   void Data::write(std::ostream &stream) const {
-    uint32_t offset = 0; // current position in ram
+    std::vector<uint8_t> bytes = image();
+    stream.write((const char *) bytes.data(), (std::streamsize) bytes.size());
+  }
+
+  std::vector<uint8_t> Data::image() const {
+    // lay out header and chunks in one zero-filled buffer, so gaps need not be written
+    std::vector<uint8_t> image(2 * sizeof(uint64_t) + get_bytes());
 
     // write header
     // entry point
     auto label = labels.find(main_label);
     uint64_t value = label == labels.end() ? 0 : label->second.addr;
-    stream.write((char *) &value, sizeof(value));
+    std::memcpy(image.data(), &value, sizeof(value));
 
     if (cli_args.debug)
       std::cout << "start address: 0x" << std::hex << value << std::dec << std::endl;
@@ -33,25 +234,237 @@ namespace assembler {
     // interrupt handler
     label = labels.find(interrupt_label);
     value = label == labels.end() ? constants::default_interrupt_handler : label->second.addr;
-    stream.write((char *) &value, sizeof(value));
+    std::memcpy(image.data() + sizeof(uint64_t), &value, sizeof(value));
 
     if (cli_args.debug)
       std::cout << "interrupt handler address: 0x" << std::hex << value << std::dec << std::endl;
 
-    // write chunks, filling in gaps between chunks as required for contiguous layout
+    write_chunks(image.data() + 2 * sizeof(uint64_t));
+    return image;
+  }
+
+  void Data::write_chunks(uint8_t *image) const {
     for (auto &chunk: buffer) {
-      while (chunk->offset > offset) {
-        stream << 0x00;
-        offset++;
+      buffer.write(chunk, image + chunk.offset);
+    }
+  }
+
+  void Data::write_line_table(std::ostream &stream) const {
+    std::vector<std::string> files;
+    std::unordered_map<std::string, uint32_t> file_index;
+
+    // paths are canonicalised as in reconstructed assembly, once per file
+    auto get_file = [&](const std::filesystem::path &path) {
+      auto [it, inserted] = file_index.insert({path.string(), files.size()});
+      if (inserted) files.push_back(weakly_canonical(path).string());
+      return it->second;
+    };
+
+    std::map<std::pair<std::string, int>, const Location *> origin_of;
+
+    for (const auto &[loc, origin]: line_origins) {
+      origin_of.insert({{loc.path().string(), loc.line()}, &origin});
+    }
+
+    std::vector<line_table::Entry> entries;
+    entries.reserve(buffer.size());
+
+    for (const Chunk &chunk: buffer) {
+      const Location &loc = lines[chunk.line].first;
+      line_table::Entry entry{chunk.offset, get_file(loc.path()), loc.line(), line_table::no_file, -1, -1,
+                              (uint32_t) entries.size()};
+
+      if (auto it = origin_of.find({loc.path().string(), loc.line()}); it != origin_of.end()) {
+        entry.origin_file = get_file(it->second->path());
+        entry.origin_line = it->second->line();
+        entry.origin_column = it->second->column();
+      }
+
+      entries.push_back(entry);
+    }
+
+    line_table::write(stream, files, std::move(entries));
+  }
+
+  /** Write a string as a JSON string literal. */
+  static void write_json_string(std::ostream &stream, const std::string &string) {
+    stream << '"';
+
+    for (char ch: string) {
+      if ((unsigned char) ch < 0x20) {
+        // control characters must be escaped
+        stream << "\\u00" << std::hex << std::setw(2) << std::setfill('0') << (int) ch << std::dec << std::setfill(' ');
+        continue;
+      }
+
+      if (ch == '"' || ch == '\\') stream << '\\';
+      stream << ch;
+    }
+
+    stream << '"';
+  }
+
+  void Data::write_symbol_map(std::ostream &stream, bool json) const {
+    struct Size {
+      uint32_t code = 0, data = 0;
+
+      [[nodiscard]] uint32_t total() const { return code + data; }
+
+      [[nodiscard]] const char *section() const { return code ? "code" : data ? "data" : "none"; }
+    };
+
+    // each distinct label address starts a region, which ends at the next
+    std::vector<uint64_t> starts;
+
+    for (const auto &[name, label]: labels) {
+      starts.push_back(label.addr);
+    }
+
+    std::sort(starts.begin(), starts.end());
+    starts.erase(std::unique(starts.begin(), starts.end()), starts.end());
+
+    std::vector<Size> regions(starts.size());
+    std::map<std::string, Size> files;
+    Size total;
+
+    for (const Chunk &chunk: buffer) {
+      bool is_code = chunk.type == ChunkType::Instruction;
+      Size &file = files[lines[chunk.line].first.path().string()];
+      (is_code ? file.code : file.data) += chunk.size;
+      (is_code ? total.code : total.data) += chunk.size;
+
+      // chunks before the first label belong to no symbol
+      auto region = std::upper_bound(starts.begin(), starts.end(), chunk.offset);
+      if (region == starts.begin()) continue;
+      Size &size = regions[region - starts.begin() - 1];
+      (is_code ? size.code : size.data) += chunk.size;
+    }
+
+    // list symbols in address order
+    std::vector<std::pair<const std::string *, const Label *>> symbols;
+
+    for (const auto &[name, label]: labels) {
+      symbols.emplace_back(&name, &label);
+    }
+
+    std::stable_sort(symbols.begin(), symbols.end(), [](const auto &a, const auto &b) {
+      return a.second->addr < b.second->addr;
+    });
+
+    auto size_of = [&](const Label &label) -> const Size & {
+      return regions[std::lower_bound(starts.begin(), starts.end(), label.addr) - starts.begin()];
+    };
+
+    if (json) {
+      // one symbol or file per line
+      stream << "{" << std::endl << "  \"size\": " << get_bytes() << "," << std::endl << "  \"symbols\": [" << std::endl;
+
+      for (size_t i = 0; i < symbols.size(); i++) {
+        const auto &[name, label] = symbols[i];
+        const Size &size = size_of(*label);
+        std::ostringstream location;
+        location << label->loc;
+
+        stream << "    {\"name\": ";
+        write_json_string(stream, *name);
+        stream << ", \"address\": " << label->addr << ", \"size\": " << size.total() << ", \"section\": \""
+               << size.section() << "\", \"location\": ";
+        write_json_string(stream, location.str());
+        stream << "}" << (i + 1 < symbols.size() ? "," : "") << std::endl;
       }
 
-      chunk->write(stream);
-      offset += chunk->size();
+      stream << "  ]," << std::endl << "  \"files\": [" << std::endl;
+
+      for (auto it = files.begin(); it != files.end(); it++) {
+        stream << "    {\"path\": ";
+        write_json_string(stream, it->first);
+        stream << ", \"code\": " << it->second.code << ", \"data\": " << it->second.data << ", \"total\": "
+               << it->second.total() << "}" << (std::next(it) != files.end() ? "," : "") << std::endl;
+      }
+
+      stream << "  ]," << std::endl << "  \"total\": {\"code\": " << total.code << ", \"data\": " << total.data
+             << ", \"total\": " << total.total() << "}" << std::endl << "}" << std::endl;
+      return;
+    }
+
+    stream << "Symbols:" << std::endl << "  address           size  section  name (location)" << std::endl;
+
+    for (const auto &[name, label]: symbols) {
+      const Size &size = size_of(*label);
+
+      stream << "  0x" << std::hex << std::setw(8) << std::setfill('0') << label->addr << std::dec << std::setfill(' ')
+             << std::setw(12) << size.total() << "  " << std::left << std::setw(7) << size.section() << std::right
+             << "  " << *name << " (" << label->loc << ")" << std::endl;
+    }
+
+    stream << std::endl << "Files:" << std::endl << "        code        data       total  path" << std::endl;
+
+    for (const auto &[path, size]: files) {
+      stream << std::setw(12) << size.code << std::setw(12) << size.data << std::setw(12) << size.total() << "  "
+             << path << std::endl;
     }
+
+    stream << std::setw(12) << total.code << std::setw(12) << total.data << std::setw(12) << total.total()
+           << "  (total)" << std::endl << std::endl << "Image size: " << get_bytes() << " bytes" << std::endl;
   }
 
-  void Data::add_chunk(std::unique_ptr<Chunk> chunk) {
-    offset += chunk->size();
-    buffer.push_back(std::move(chunk));
+  object::Object Data::to_object(message::List &msgs) const {
+    object::Object object;
+
+    // assemble image as if loaded at address 0
+    object.image.resize(get_bytes());
+    write_chunks(object.image.data());
+
+    // locate symbols and relocations by source line, so the linker may report where they came from
+    std::unordered_map<std::string, uint32_t> file_index;
+
+    auto get_source = [&](const Location &loc) -> object::Source {
+      auto [it, inserted] = file_index.insert({loc.path().string(), object.files.size()});
+      if (inserted) object.files.push_back(loc.path().string());
+      return {it->second, loc.line()};
+    };
+
+    // every label is a symbol, but only those declared .global (or special) are visible to other objects
+    std::unordered_map<std::string, uint32_t> symbol_index;
+
+    for (const auto &[name, label]: labels) {
+      bool global = globals.contains(name) || name == main_label || name == interrupt_label;
+      symbol_index.insert({name, object.symbols.size()});
+      object.symbols.push_back({name, true, global, label.addr, get_source(label.loc)});
+    }
+
+    for (const Reference &reference: references) {
+      // references to undeclared labels are imported as undefined symbols
+      auto [symbol, inserted] = symbol_index.insert({reference.label, object.symbols.size()});
+      if (inserted) object.symbols.push_back({reference.label, false});
+
+      object::Relocation relocation{reference.offset, 0, uint8_t(reference.arg * 8), symbol->second,
+                                    reference.addend, get_source(lines[reference.line].first)};
+
+      if (reference.instruction >= 0) {
+        // locate the argument's field, which always ends with its 32-bit address
+        std::vector<uint8_t> bounds;
+        (void) buffer.instruction(reference.instruction).compile(&bounds);
+
+        if (bounds[reference.arg + 1] - bounds[reference.arg] < 32) {
+          auto chunk = std::find_if(buffer.begin(), buffer.end(), [&](const Chunk &chunk) {
+            return chunk.type == ChunkType::Instruction && chunk.index == reference.instruction;
+          });
+
+          auto msg = std::make_unique<message::Message>(message::Error, location(*chunk));
+          msg->get() << "reference to label " << reference.label << " cannot be relocated, as its field is narrower "
+                        "than 32 bits";
+          msgs.add(std::move(msg));
+          continue;
+        }
+
+        relocation.bit = bounds[reference.arg + 1] - 32;
+        relocation.width = 32;
+      }
+
+      object.relocations.push_back(relocation);
+    }
+
+    return object;
   }
 }
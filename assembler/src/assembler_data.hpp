@@ -3,17 +3,31 @@
 #include "chunk.hpp"
 #include "pre-process/data.hpp"
 #include "label.hpp"
+#include "object.hpp"
+#include "messages/list.hpp"
+
+#include <unordered_set>
 
 namespace assembler {
   struct Data {
     CliArguments &cli_args;
     std::filesystem::path file_path; // Name of source file
     std::vector<pre_processor::Line> lines; // List of source file lines
+    std::vector<std::pair<Location, Location>> line_origins; // Maps a line's location to its origin, see pre_processor::Data
     std::map<std::string, Label> labels;
-    uint16_t offset; // byte offset into source
+    uint32_t offset; // byte offset into output
+    int64_t overflow_line = -1; // Index of the line whose chunk first passed the end of the address space, or -1
     std::string main_label; // Contain "main" label name
     std::string interrupt_label; // Contains "interrupt_handler" label name
-    std::deque<std::unique_ptr<Chunk>> buffer; // List of compiled chunks
+    ChunkBuffer buffer; // Compiled chunks
+    std::unordered_set<std::string> label_names; // Interned names of referenced labels, see intern()
+    std::unordered_map<const std::string *, std::vector<Fixup>> fixups; // References to labels which are yet to be declared
+    std::vector<Reference> references; // All label references, only recorded if assembling a relocatable object or optimising
+    std::vector<uint32_t> origins; // Offsets set by .org, in order
+    std::unordered_set<std::string> globals; // Labels exported from a relocatable object by .global
+    std::vector<std::string> pending_labels; // Labels declared since the last chunk, placed with it, see place_labels()
+    std::unordered_map<std::string, uint32_t> constant_pool; // Offset of the first copy of the bytes of each .const
+    uint32_t alignment = 1; // Least common multiple of all alignments, chunks are only moved by multiples of this
 
     explicit Data(CliArguments &cli_args) : cli_args(cli_args), offset(0) {
       main_label = "main";
@@ -22,18 +36,82 @@ namespace assembler {
 
     explicit Data(pre_processor::Data &data) : Data(data.cli_args) {
       lines = data.lines;
+      line_origins = data.line_origins;
     }
 
-    /** Add a new chunk. */
-    void add_chunk(std::unique_ptr<Chunk> chunk);
+    /** Advance the offset past a chunk of <size> bytes from line <line>, noting the line if the offset wraps. */
+    void advance(uint32_t line, uint64_t size);
+
+    /** Add an instruction from source line <line>, return its index in the buffer. */
+    uint32_t add_instruction(uint32_t line, instruction::Instruction instruction);
+
+    /** Add bytes from a data directive. */
+    void add_data(uint32_t line, int column, const std::vector<uint8_t> &bytes);
+
+    /** Add <size> zero bytes. */
+    void add_space(uint32_t line, int column, uint32_t size);
+
+    /**
+     * Pad with zero bytes to a multiple of <alignment>, moving pending labels past the padding so they label what follows.
+     * Return the number of bytes added.
+     */
+    uint32_t align(uint32_t line, int column, uint32_t alignment);
+
+    /**
+     * Undo the last align(), which added <padding> bytes to a buffer of the given <extent>. Pending labels are left past
+     * the padding, so must be moved.
+     */
+    void unalign(uint32_t padding, uint32_t extent);
+
+    /** Patch past references to pending labels with their addresses, which are now final. */
+    void place_labels();
+
+    /** Get source location of a chunk. */
+    [[nodiscard]] Location location(const Chunk &chunk) const;
+
+    /** Return the interned copy of a label name, which lives as long as this. */
+    const std::string *intern(const std::string &label);
 
-    /** Replace all instances of <label> with the given <address>. */
-    void replace_label(const std::string &label, uint32_t address) const;
+    /** Replace label arguments of the instruction at <index> with their address if declared, else record a fixup. */
+    void resolve_references(uint32_t index);
+
+    /** Patch all recorded references to <label> with the given <address>. */
+    void resolve_label(const std::string &label, uint32_t address);
+
+    /** Can chunks be moved? Not if a .org moved backwards, as chunks may then overlap. */
+    [[nodiscard]] bool is_movable() const;
+
+    /**
+     * Remove flagged chunks, moving later chunks, labels and label references down to close the gaps, except where fixed
+     * by a .org. References from `touched` instructions and from removed data are dropped.
+     */
+    void remove_chunks(const std::vector<bool> &removed, const std::vector<bool> &touched);
 
     /** Get size in bytes. */
     [[nodiscard]] uint32_t get_bytes() const;
 
     /** Write data to output stream. */
     void write(std::ostream &stream) const;
+
+    /** Return the binary, as written by write(). */
+    [[nodiscard]] std::vector<uint8_t> image() const;
+
+    /** Write chunks into <image> at their offsets, without a header. <image> must hold get_bytes() zeroed bytes. */
+    void write_chunks(uint8_t *image) const;
+
+    /** Write a line table, mapping the offset of each chunk to its source line and origin. */
+    void write_line_table(std::ostream &stream) const;
+
+    /**
+     * Write a symbol map, listing each label with its address, its size up to the next label and whether it is code or
+     * data, then the bytes contributed by each source file. Written as JSON if <json>, else as text.
+     */
+    void write_symbol_map(std::ostream &stream, bool json) const;
+
+    /**
+     * Construct a relocatable object. Global labels, and the main label and interrupt handler, are exported; others are
+     * local to the object. An error is raised for each reference whose field is too narrow to be relocated.
+     */
+    [[nodiscard]] object::Object to_object(message::List &msgs) const;
   };
 }
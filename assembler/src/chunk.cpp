@@ -1,91 +1,109 @@
 #include "chunk.hpp"
 
+#include <algorithm>
+#include <cstring>
 #include <iomanip>
 
 namespace assembler {
-  void Chunk::debug_print(std::ostream &os) {
-    os << "Chunk at +0x" << std::hex << offset << std::dec << " of " << size() << " bytes";
+  uint32_t ChunkBuffer::add_instruction(uint32_t line, uint32_t offset, instruction::Instruction instruction) {
+    auto index = (uint32_t) m_instructions.size();
+    m_instructions.push_back(std::move(instruction));
+    m_chunks.push_back({ChunkType::Instruction, offset, sizeof(uint64_t), index, line, -1});
+    m_extent = std::max(m_extent, offset + (uint32_t) sizeof(uint64_t));
+    return index;
   }
 
-  void InstructionChunk::debug_print(std::ostream& os) {
-    Chunk::debug_print(os);
-
-    std::cout << " - instruction 0x" << std::hex << m_instruction->compile() << std::dec << std::endl
-              << '\t';
-    m_instruction->debug_print(os);
-  }
-
-  void InstructionChunk::write(std::ostream& os) {
-    uint64_t data = m_instruction->compile();
-    os.write((char *) &data, sizeof(data));
+  void ChunkBuffer::add_data(uint32_t line, int column, uint32_t offset, const std::vector<uint8_t> &bytes) {
+    m_chunks.push_back({ChunkType::Data, offset, (uint32_t) bytes.size(), (uint32_t) m_bytes.size(), line, column});
+    m_bytes.insert(m_bytes.end(), bytes.begin(), bytes.end());
+    m_extent = std::max(m_extent, offset + (uint32_t) bytes.size());
   }
 
-  void InstructionChunk::reconstruct(std::ostream& os) {
-    m_instruction->print(os);
+  void ChunkBuffer::add_space(uint32_t line, int column, uint32_t offset, uint32_t size) {
+    m_chunks.push_back({ChunkType::Space, offset, size, 0, line, column});
+    m_extent = std::max(m_extent, offset + size);
   }
 
-  void InstructionChunk::replace_label(const std::string& label, uint32_t address, bool debug) {
-    m_instruction->replace_label(label, address, debug);
-  }
+  void ChunkBuffer::erase(const std::vector<bool> &removed) {
+    size_t i = 0;
+    std::erase_if(m_chunks, [&](const Chunk &) { return removed[i++]; });
 
-  const instruction::ArgumentLabel* InstructionChunk::get_first_label() const {
-    for (auto &arg: m_instruction->args) {
-      if (arg.is_label()) {
-        return arg.get_label();
-      }
+    m_extent = 0;
+    for (const Chunk &chunk: m_chunks) {
+      m_extent = std::max(m_extent, chunk.offset + chunk.size);
     }
-
-    return nullptr;
   }
 
-  uint16_t DataChunk::size() const {
-    return m_bytes.size();
-  }
-
-  void DataChunk::debug_print(std::ostream& os) {
-    Chunk::debug_print(os);
-    os << " - data:" << std::endl << '\t' << std::uppercase << std::hex;
-
-    for (int i = 0; i < m_bytes.size(); i++) {
-      os << std::setw(2) << std::setfill('0') << int(m_bytes[i]);
-      if (i + 1 < m_bytes.size()) os << " ";
+  void ChunkBuffer::debug_print(const Chunk &chunk, std::ostream &os) const {
+    os << "Chunk at +0x" << std::hex << chunk.offset << std::dec << " of " << chunk.size << " bytes";
+
+    switch (chunk.type) {
+      case ChunkType::Instruction:
+        std::cout << " - instruction 0x" << std::hex << m_instructions[chunk.index].compile() << std::dec << std::endl
+                  << '\t';
+        m_instructions[chunk.index].debug_print(os);
+        break;
+      case ChunkType::Data:
+        os << " - data:" << std::endl << '\t' << std::uppercase << std::hex;
+
+        for (uint32_t i = 0; i < chunk.size; i++) {
+          os << std::setw(2) << std::setfill('0') << int(m_bytes[chunk.index + i]);
+          if (i + 1 < chunk.size) os << " ";
+        }
+
+        std::cout << std::dec << std::endl;
+        break;
+      case ChunkType::Space:
+        os << " - space (0x" << std::hex << chunk.size << std::dec << ")" << std::endl;
+        break;
     }
-
-    std::cout << std::dec << std::endl;
   }
 
-  void DataChunk::write(std::ostream& os) {
-    for (uint8_t byte: m_bytes) {
-      os.write((char *) &byte, sizeof(byte));
+  void ChunkBuffer::write(const Chunk &chunk, uint8_t *dest) const {
+    switch (chunk.type) {
+      case ChunkType::Instruction: {
+        uint64_t data = m_instructions[chunk.index].compile();
+        std::memcpy(dest, &data, sizeof(data));
+        break;
+      }
+      case ChunkType::Data:
+        std::memcpy(dest, m_bytes.data() + chunk.index, chunk.size);
+        break;
+      case ChunkType::Space:
+        std::memset(dest, 0x00, chunk.size);
+        break;
     }
   }
 
-  void DataChunk::reconstruct(std::ostream& os) {
-    os << ".byte" << std::hex;
-
-    for (uint8_t byte: m_bytes) {
-      os << " 0x" << int(byte);
+  void ChunkBuffer::reconstruct(const Chunk &chunk, std::ostream &os) const {
+    switch (chunk.type) {
+      case ChunkType::Instruction:
+        m_instructions[chunk.index].print(os);
+        break;
+      case ChunkType::Data:
+        os << ".byte" << std::hex;
+
+        for (uint32_t i = 0; i < chunk.size; i++) {
+          os << " 0x" << int(m_bytes[chunk.index + i]);
+        }
+
+        os << std::dec;
+        break;
+      case ChunkType::Space:
+        os << ".space 0x" << std::hex << chunk.size << std::dec;
+        break;
     }
-
-    os << std::dec;
-  }
-
-  uint16_t SpaceDirectiveChunk::size() const {
-    return m_value;
   }
 
-  void SpaceDirectiveChunk::debug_print(std::ostream& os) {
-    Chunk::debug_print(os);
-    os << " - space (0x" << std::hex << m_value << std::dec << ")" << std::endl;
-  }
+  const instruction::ArgumentLabel *ChunkBuffer::get_first_label(const Chunk &chunk) const {
+    if (chunk.type != ChunkType::Instruction) return nullptr;
 
-  void SpaceDirectiveChunk::write(std::ostream& os) {
-    for (uint32_t i = 0; i < m_value; i++) {
-      os << 0x00;
+    for (auto &arg: m_instructions[chunk.index].args) {
+      if (arg.is_label()) {
+        return arg.get_label();
+      }
     }
-  }
 
-  void SpaceDirectiveChunk::reconstruct(std::ostream& os) {
-    os << ".space 0x" << std::hex << m_value << std::dec;
+    return nullptr;
   }
 }
@@ -5,87 +5,87 @@
 #include "instructions/instruction.hpp"
 
 namespace assembler {
-  class Chunk {
-  public:
+  /** Type of a chunk, which determines where its contents are stored. */
+  enum class ChunkType : uint8_t {
+    Instruction, // an instruction word
+    Data, // bytes from a data directive
+    Space, // zero bytes from .space
+  };
+
+  /** Contiguous region of the output. Its contents are stored in the owning ChunkBuffer. */
+  struct Chunk {
+    ChunkType type;
     uint32_t offset; // Byte offset
+    uint32_t size; // Size in bytes
+    uint32_t index; // Index into the buffer's instructions, or into its byte pool for data
+    uint32_t line; // Index of the source line
+    int column; // Column of the source location, or -1
+  };
 
-  private:
-    Location m_source; // source location
-//    std::unique_ptr<instruction::Instruction> m_instruction = nullptr;
-//    std::unique_ptr<std::vector<uint8_t>> m_bytes = nullptr;
+  /**
+   * Struct-of-arrays store of compiled chunks: instructions are held in one contiguous table and the bytes of data
+   * directives in one pool, so adding a chunk does not allocate once the tables have grown.
+   */
+  class ChunkBuffer {
+    std::vector<Chunk> m_chunks;
+    std::vector<instruction::Instruction> m_instructions;
+    std::vector<uint8_t> m_bytes;
+    uint32_t m_extent = 0; // End offset of the furthest chunk
 
   public:
-    Chunk(Location source, uint32_t offset) : m_source(std::move(source)), offset(offset) {}
-
-    virtual ~Chunk() = default;
-
-    virtual void debug_print(std::ostream &os);
-
-    [[nodiscard]] virtual uint16_t size() const = 0;
-
-    [[nodiscard]] const Location &location() const { return m_source; }
-
-    virtual void write(std::ostream &os) = 0;
-
-    virtual void reconstruct(std::ostream &os) = 0;
+    [[nodiscard]] bool empty() const { return m_chunks.empty(); }
 
-    /** Replace given label with its address */
-    virtual void replace_label(const std::string& label, uint32_t address, bool debug = false) {}
+    [[nodiscard]] size_t size() const { return m_chunks.size(); }
 
-    /** Return first, if any, label we come across */
-    virtual const instruction::ArgumentLabel* get_first_label() const
-    { return nullptr; }
-  };
+    [[nodiscard]] const Chunk &back() const { return m_chunks.back(); }
 
-  class InstructionChunk : public Chunk {
-    std::unique_ptr<instruction::Instruction> m_instruction;
+    [[nodiscard]] Chunk &operator[](size_t index) { return m_chunks[index]; }
 
-  public:
-    InstructionChunk(Location source, uint32_t offset, std::unique_ptr<instruction::Instruction> i)
-      : Chunk(std::move(source), offset), m_instruction(std::move(i)) {}
+    [[nodiscard]] const Chunk &operator[](size_t index) const { return m_chunks[index]; }
 
-    uint16_t size() const override { return sizeof(uint64_t); }
+    /** Get the end offset of the furthest chunk, i.e., the size of the image. */
+    [[nodiscard]] uint32_t extent() const { return m_extent; }
 
-    void debug_print(std::ostream &os) override;
+    [[nodiscard]] std::vector<Chunk>::const_iterator begin() const { return m_chunks.begin(); }
 
-    void write(std::ostream &os) override;
+    [[nodiscard]] std::vector<Chunk>::const_iterator end() const { return m_chunks.end(); }
 
-    void reconstruct(std::ostream &os) override;
+    [[nodiscard]] instruction::Instruction &instruction(uint32_t index) { return m_instructions[index]; }
 
-    void replace_label(const std::string &label, uint32_t address, bool debug = false) override;
+    [[nodiscard]] const instruction::Instruction &instruction(uint32_t index) const { return m_instructions[index]; }
 
-    const instruction::ArgumentLabel* get_first_label() const override;
-  };
+    /** Get the number of instructions, including those of removed chunks. */
+    [[nodiscard]] size_t instruction_count() const { return m_instructions.size(); }
 
-  class DataChunk : public Chunk {
-    std::vector<uint8_t> m_bytes;
+    /** Get the bytes of a data chunk. */
+    [[nodiscard]] uint8_t *bytes(const Chunk &chunk) { return m_bytes.data() + chunk.index; }
 
-  public:
-    DataChunk(Location source, uint32_t offset, std::vector<uint8_t> bytes)
-      : Chunk(std::move(source), offset), m_bytes(std::move(bytes)) {}
+    /** Add an instruction chunk, return the index of the instruction. */
+    uint32_t add_instruction(uint32_t line, uint32_t offset, instruction::Instruction instruction);
 
-      uint16_t size() const override;
+    /** Add a data chunk containing the given bytes. */
+    void add_data(uint32_t line, int column, uint32_t offset, const std::vector<uint8_t> &bytes);
 
-      void debug_print(std::ostream &os) override;
+    /** Add a chunk of the given number of zero bytes. */
+    void add_space(uint32_t line, int column, uint32_t offset, uint32_t size);
 
-      void write(std::ostream &os) override;
+    /** Remove the last chunk, restoring the extent to <extent>, as it was before the chunk was added. */
+    void pop_back(uint32_t extent) {
+      m_chunks.pop_back();
+      m_extent = extent;
+    }
 
-      void reconstruct(std::ostream &os) override;
-  };
-
-  class SpaceDirectiveChunk : public Chunk {
-    uint32_t m_value;
+    /** Remove the flagged chunks. The contents of removed instructions and data are kept, so indices remain valid. */
+    void erase(const std::vector<bool> &removed);
 
-  public:
-    SpaceDirectiveChunk(Location source, uint32_t offset, uint32_t value)
-      : Chunk(std::move(source), offset), m_value(value) {}
+    void debug_print(const Chunk &chunk, std::ostream &os) const;
 
-    uint16_t size() const override;
+    /** Write chunk's contents to <dest>, which must hold at least chunk.size bytes. */
+    void write(const Chunk &chunk, uint8_t *dest) const;
 
-    void debug_print(std::ostream &os) override;
+    void reconstruct(const Chunk &chunk, std::ostream &os) const;
 
-    void write(std::ostream &os) override;
-
-    void reconstruct(std::ostream &os) override;
+    /** Return first, if any, label we come across */
+    [[nodiscard]] const instruction::ArgumentLabel *get_first_label(const Chunk &chunk) const;
   };
 }
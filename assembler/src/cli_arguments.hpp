@@ -1,17 +1,27 @@
 #pragma once
 
 #include "named_fstream.hpp"
+#include <functional>
 #include <memory>
+#include <string>
+#include <vector>
 
 namespace assembler {
   struct CliArguments {
     std::unique_ptr<named_fstream> source; // source file
+    std::vector<std::unique_ptr<named_fstream>> linked_sources; // further source files, assembled in parallel and linked with source
     std::unique_ptr<named_fstream> output_file; // file for compiler machine code
     std::unique_ptr<named_fstream> post_processing_file; // file for post-processed assembly
     std::filesystem::path lib_path; // path to lib folder
+    std::function<bool(const std::filesystem::path &, std::string &)> include_resolver; // reads %include-d files into the string, return success, or read from disk if empty
+    std::filesystem::path cache_path; // directory to cache pre-processed %include-d files in, or empty if disabled
     bool debug = false;
     bool do_compilation = true;
     bool do_pre_processing = true;
+    bool relocatable = false; // emit a relocatable object instead of a binary
+    bool optimise = false; // remove dead code and run the peephole optimiser over parsed instructions
     std::unique_ptr<named_fstream> reconstructed_asm_file; // file for reconstructed assembly
+    std::unique_ptr<named_fstream> line_table_file; // file for binary line table
+    std::unique_ptr<named_fstream> symbol_map_file; // file for symbol map, written as JSON if its extension is .json
   };
 }
@@ -0,0 +1,143 @@
+#include "dead_code.hpp"
+#include "instructions/signature.hpp"
+
+#include <algorithm>
+
+#include "constants.hpp"
+
+namespace assembler::dead_code {
+  using namespace constants;
+  using instruction::ArgumentType;
+  using instruction::Instruction;
+
+  /** Does execution never continue past the instruction, i.e., is it an unconditional jump or exit? */
+  static bool ends_flow(const Instruction &instruction) {
+    if (instruction.is_conditional() || instruction.args.empty()) return false;
+
+    const auto &arg = instruction.args[0];
+
+    switch (instruction.signature->opcode) {
+      case inst::_load:
+        return arg.get_type() == ArgumentType::Register && arg.get_data() == registers::pc;
+      case inst::_syscall:
+        return arg.get_type() == ArgumentType::Immediate && arg.get_data() == (uint64_t) syscall::exit;
+      default:
+        return false;
+    }
+  }
+
+  uint32_t eliminate(Data &data) {
+    if (!data.is_movable()) {
+      if (data.cli_args.debug)
+        std::cout << "dead code: skipped, as .org moves backwards" << std::endl;
+
+      return 0;
+    }
+
+    // regions start at the beginning, at each .org and at each label
+    std::vector<uint64_t> starts{0};
+    starts.insert(starts.end(), data.origins.begin(), data.origins.end());
+
+    for (const auto &[name, label]: data.labels) {
+      starts.push_back(label.addr);
+    }
+
+    std::sort(starts.begin(), starts.end());
+    starts.erase(std::unique(starts.begin(), starts.end()), starts.end());
+
+    auto region_of = [&starts](uint64_t offset) -> size_t {
+      return std::upper_bound(starts.begin(), starts.end(), offset) - starts.begin() - 1;
+    };
+
+    // regions reached by label references from each region
+    std::vector<std::vector<size_t>> edges(starts.size());
+
+    for (const Reference &reference: data.references) {
+      auto label = data.labels.find(reference.label);
+      if (label == data.labels.end()) continue;
+
+      auto &targets = edges[region_of(reference.offset)];
+      targets.push_back(region_of(label->second.addr));
+
+      // an offset from a label may point into a following region
+      if (int64_t address = int64_t(label->second.addr) + reference.addend; address >= 0) {
+        targets.push_back(region_of(address));
+      }
+    }
+
+    // does execution fall through into the next region? Not after data, nor after a jump or exit
+    std::vector<bool> falls_through(starts.size(), true);
+
+    for (const Chunk &chunk: data.buffer) {
+      falls_through[region_of(chunk.offset)] =
+          chunk.type == ChunkType::Instruction && !ends_flow(data.buffer.instruction(chunk.index));
+    }
+
+    // roots: entry points, and regions which are not labelled or are placed by .org, so may be reached by address
+    std::vector<bool> labelled(starts.size());
+
+    for (const auto &[name, label]: data.labels) {
+      labelled[region_of(label.addr)] = true;
+    }
+
+    std::vector<size_t> stack;
+
+    for (size_t i = 0; i < starts.size(); i++) {
+      if (!labelled[i]) stack.push_back(i);
+    }
+
+    for (uint32_t origin: data.origins) {
+      stack.push_back(region_of(origin));
+    }
+
+    auto entry = data.labels.find(data.main_label);
+    stack.push_back(entry == data.labels.end() ? 0 : region_of(entry->second.addr));
+
+    if (auto handler = data.labels.find(data.interrupt_label); handler != data.labels.end()) {
+      stack.push_back(region_of(handler->second.addr));
+    }
+
+    std::vector<bool> reachable(starts.size());
+
+    while (!stack.empty()) {
+      size_t region = stack.back();
+      stack.pop_back();
+
+      if (reachable[region]) continue;
+      reachable[region] = true;
+
+      stack.insert(stack.end(), edges[region].begin(), edges[region].end());
+      if (falls_through[region] && region + 1 < starts.size()) stack.push_back(region + 1);
+    }
+
+    // remove chunks in unreachable regions, and the labels which delimit them
+    std::vector<bool> removed(data.buffer.size());
+    std::vector<bool> touched(data.buffer.instruction_count());
+    uint32_t removed_bytes = 0;
+
+    for (size_t i = 0; i < data.buffer.size(); i++) {
+      const Chunk &chunk = data.buffer[i];
+      if (reachable[region_of(chunk.offset)]) continue;
+
+      removed[i] = true;
+      removed_bytes += chunk.size;
+      if (chunk.type == ChunkType::Instruction) touched[chunk.index] = true;
+    }
+
+    std::erase_if(data.labels, [&](const auto &entry) {
+      if (reachable[region_of(entry.second.addr)]) return false;
+
+      if (data.cli_args.debug)
+        std::cout << entry.second.loc << " dead code: removed unreachable label " << entry.first << std::endl;
+
+      return true;
+    });
+
+    if (removed_bytes > 0) data.remove_chunks(removed, touched);
+
+    if (data.cli_args.debug)
+      std::cout << "dead code: removed " << removed_bytes << " byte(s)" << std::endl;
+
+    return removed_bytes;
+  }
+}
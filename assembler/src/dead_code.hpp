@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cstdint>
+
+#include "assembler_data.hpp"
+
+/**
+ * Dead code elimination over parsed chunks. The output is split into regions at each label and .org, and a region is
+ * kept if it is reachable from main or interrupt_handler by a label reference or by falling through from the region
+ * before it. Unreachable regions are removed, and following chunks moved down as in the peephole optimiser.
+ */
+namespace assembler::dead_code {
+  /** Remove unreachable regions from `data`, return the number of bytes removed. */
+  uint32_t eliminate(Data &data);
+}
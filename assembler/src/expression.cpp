@@ -0,0 +1,287 @@
+#include "expression.hpp"
+#include "util.hpp"
+
+#include <cstring>
+#include <unordered_map>
+
+namespace assembler::expression {
+  struct Operator {
+    const char *symbol;
+    int precedence; // higher binds more tightly
+  };
+
+  const Operator operators[] = {
+      {"|",  1},
+      {"&",  2},
+      {"<<", 3},
+      {">>", 3},
+      {"+",  4},
+      {"-",  4},
+      {"*",  5},
+      {"/",  5},
+  };
+
+  /** Size in bytes of each operand of `sizeof`: data directives, and datatype suffixes. */
+  static const std::unordered_map<std::string, uint64_t> sizes = {
+      {"byte", 1},
+      {"data", 4},
+      {"word", 8},
+      {"hu",   4},
+      {"hi",   4},
+      {"f",    4},
+      {"u",    8},
+      {"i",    8},
+      {"d",    8},
+  };
+
+  static bool parse_expression(const std::string &line, int &col, const Location &loc, message::List &msgs,
+                               Value &result, int min_precedence);
+
+  /** Match a binary operator after `col`, skipping whitespace before it. If none, return nullptr and leave `col`. */
+  static const Operator *match_operator(const std::string &line, int &col) {
+    int i = col;
+    skip_whitespace(line, i);
+
+    for (const Operator &op: operators) {
+      size_t length = std::strlen(op.symbol);
+      if (line.compare(i, length, op.symbol) != 0) continue;
+
+      // "1 -2" is two items, the second negative
+      if (i > col && op.symbol[0] == '-' && i + length < line.size() && line[i + length] != ' ') return nullptr;
+
+      col = i + (int) length;
+      return &op;
+    }
+
+    return nullptr;
+  }
+
+  /** Report an error at the given column. */
+  static void error(const Location &loc, int col, message::List &msgs, const std::string &message) {
+    auto msg = std::make_unique<message::Message>(message::Error, loc.copy().column(col));
+    msg->get() << message;
+    msgs.add(std::move(msg));
+  }
+
+  /** Parse `sizeof(<name>)`, `col` pointing after "sizeof". */
+  static bool parse_sizeof(const std::string &line, int &col, const Location &loc, message::List &msgs,
+                           Value &result) {
+    col++;
+    skip_whitespace(line, col);
+
+    int start = col;
+    skip_label(line, col);
+    auto size = sizes.find(line.substr(start, col - start));
+
+    if (size == sizes.end()) {
+      error(loc, start, msgs, "sizeof: expected a data directive or datatype, e.g., word or u");
+      return false;
+    }
+
+    skip_whitespace(line, col);
+
+    if (col >= line.size() || line[col] != ')') {
+      error(loc, col, msgs, "sizeof: expected ')'");
+      return false;
+    }
+
+    col++;
+    result.value = size->second;
+    return true;
+  }
+
+  /** Parse a single operand: a number, character literal, label, `sizeof(...)`, negation or group. */
+  static bool parse_primary(const std::string &line, int &col, const Location &loc, message::List &msgs,
+                            Value &result) {
+    if (col >= line.size()) {
+      error(loc, col, msgs, "expected expression, got end of line");
+      return false;
+    }
+
+    int start = col;
+    char ch = line[col];
+
+    // group
+    if (ch == '(') {
+      col++;
+      if (!parse_expression(line, col, loc, msgs, result, 0)) return false;
+      skip_whitespace(line, col);
+
+      if (col >= line.size() || line[col] != ')') {
+        error(loc, col, msgs, "expected ')'");
+
+        auto msg = std::make_unique<message::Message>(message::Note, loc.copy().column(start));
+        msg->get() << "group opened here";
+        msgs.add(std::move(msg));
+        return false;
+      }
+
+      col++;
+      result.is_group = true;
+      return true;
+    }
+
+    // number, which may be negative
+    if (std::isdigit(ch) || (ch == '-' && col + 1 < line.size() && std::isdigit(line[col + 1]))) {
+      if (!parse_number(line, col, result.value, result.is_decimal)) {
+        error(loc, start, msgs, "invalid number");
+        return false;
+      }
+
+      return true;
+    }
+
+    // negation
+    if (ch == '-') {
+      col++;
+      if (!parse_primary(line, col, loc, msgs, result)) return false;
+
+      if (!result.label.empty()) {
+        error(loc, start, msgs, "cannot negate label " + result.label);
+        return false;
+      }
+
+      if (result.is_decimal) {
+        double decimal = -*(double *) &result.value;
+        result.value = *(uint64_t *) &decimal;
+      } else {
+        result.value = -result.value;
+      }
+
+      result.is_group = false;
+      return true;
+    }
+
+    // character literal
+    if (ch == '\'') {
+      col++;
+
+      if (col < line.size() && line[col] == '\\') {
+        if (!decode_escape_seq(line, ++col, result.value)) {
+          error(loc, start, msgs, "invalid escape sequence");
+          return false;
+        }
+      } else if (col < line.size()) {
+        result.value = (uint8_t) line[col++];
+      }
+
+      if (col >= line.size() || line[col] != '\'') {
+        error(loc, start, msgs, "expected apostrophe to terminate character literal");
+        return false;
+      }
+
+      col++;
+      return true;
+    }
+
+    // label or sizeof
+    if (std::isalpha(ch) || ch == '_') {
+      skip_label(line, col);
+      std::string name = line.substr(start, col - start);
+
+      int after = col;
+      skip_whitespace(line, after);
+
+      if (name == "sizeof" && after < line.size() && line[after] == '(') {
+        col = after;
+        return parse_sizeof(line, col, loc, msgs, result);
+      }
+
+      result.label = std::move(name);
+      return true;
+    }
+
+    std::string message = "unexpected character '";
+    message += ch;
+    error(loc, start, msgs, message + "'");
+    return false;
+  }
+
+  /** Apply `op` to the operands, leaving the result in `lhs`. */
+  static bool apply(const Operator &op, Value &lhs, const Value &rhs, const Location &loc, int col,
+                    message::List &msgs) {
+    if (lhs.is_decimal || rhs.is_decimal) {
+      error(loc, col, msgs, "decimal numbers cannot be used in expressions");
+      return false;
+    }
+
+    // a label may only be offset by a constant: `label + c`, `c + label` or `label - c`
+    bool is_sum = op.symbol[0] == '+' && (lhs.label.empty() || rhs.label.empty());
+    bool is_difference = op.symbol[0] == '-' && rhs.label.empty();
+
+    if ((!lhs.label.empty() || !rhs.label.empty()) && !is_sum && !is_difference) {
+      error(loc, col, msgs, "a label may only be offset by adding or subtracting a constant");
+      return false;
+    }
+
+    uint64_t a = lhs.value, b = rhs.value;
+
+    switch (op.symbol[0]) {
+      case '|':
+        lhs.value = a | b;
+        break;
+      case '&':
+        lhs.value = a & b;
+        break;
+      case '<':
+        lhs.value = b >= 64 ? 0 : a << b;
+        break;
+      case '>':
+        lhs.value = b >= 64 ? 0 : a >> b;
+        break;
+      case '+':
+        lhs.value = a + b;
+        if (lhs.label.empty()) lhs.label = rhs.label;
+        break;
+      case '-':
+        lhs.value = a - b;
+        break;
+      case '*':
+        lhs.value = a * b;
+        break;
+      case '/':
+        if (b == 0) {
+          error(loc, col, msgs, "division by zero");
+          return false;
+        }
+
+        // dividing the minimum by -1 overflows, so negate instead, wrapping as the other operators do
+        lhs.value = (int64_t) b == -1 ? -a : (uint64_t) ((int64_t) a / (int64_t) b);
+        break;
+      default:
+        break;
+    }
+
+    lhs.is_group = false;
+    return true;
+  }
+
+  /** Parse operands joined by operators binding at least as tightly as `min_precedence`. */
+  static bool parse_expression(const std::string &line, int &col, const Location &loc, message::List &msgs,
+                               Value &result, int min_precedence) {
+    skip_whitespace(line, col);
+    if (!parse_primary(line, col, loc, msgs, result)) return false;
+
+    while (true) {
+      int op_col = col;
+      const Operator *op = match_operator(line, col);
+
+      if (op == nullptr || op->precedence < min_precedence) {
+        col = op_col;
+        return true;
+      }
+
+      int symbol_col = col - (int) std::strlen(op->symbol);
+      skip_whitespace(line, col);
+
+      Value rhs;
+      if (!parse_expression(line, col, loc, msgs, rhs, op->precedence + 1)) return false;
+      if (!apply(*op, result, rhs, loc, symbol_col, msgs)) return false;
+    }
+  }
+
+  bool parse(const std::string &line, int &col, const Location &loc, message::List &msgs, Value &result) {
+    result = Value();
+    return parse_expression(line, col, loc, msgs, result, 0);
+  }
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "location.hpp"
+#include "messages/list.hpp"
+
+/**
+ * Constant expressions in operands and directives, folded at assembly time. Numbers, character literals, labels and
+ * `sizeof(...)` are combined by `|`, `&`, `<<`, `>>`, `+`, `-`, `*` and `/`, which bind as in C, and grouped by
+ * parentheses. A label may only be offset by adding or subtracting a constant, so the result is resolved like any
+ * other label reference.
+ */
+namespace assembler::expression {
+  struct Value {
+    uint64_t value = 0; // constant, or offset from `label`
+    bool is_decimal = false; // is `value` the bits of a double? Only if the expression is a single number
+    bool is_group = false; // was the expression a single parenthesised group, i.e., `(...)`?
+    std::string label; // label which the value is offset from, or empty
+  };
+
+  /**
+   * Parse and evaluate an expression starting at `line[col]`, advance `col` past it. Whitespace may surround an
+   * operator, except that `1 -2` is taken as two items. Return success, reporting errors against `loc`.
+   */
+  bool parse(const std::string &line, int &col, const Location &loc, message::List &msgs, Value &result);
+}
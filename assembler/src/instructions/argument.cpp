@@ -6,19 +6,7 @@
 #include <iomanip>
 
 namespace assembler::instruction {
-  void Argument::destroy() {
-    if (m_data == 0x00) return;
-
-    if (m_type == ArgumentType::Label) {
-      delete (std::string *) m_data;
-    } else if (m_type == ArgumentType::RegisterIndirect) {
-      delete (ArgumentRegisterIndirect *) m_data;
-    }
-
-    m_data = 0x00;
-  }
-
-  Argument::Argument(ArgumentType type, uint64_t data) {
+  Argument::Argument(ArgumentType type, uint64_t data) : m_label() {
     m_type = type;
     m_data = data;
   }
@@ -48,7 +36,7 @@ namespace assembler::instruction {
         break;
       case ArgumentType::Label: {
         auto* label = get_label();
-        out << "label \"" << label->label << "\"";
+        out << "label \"" << *label->label << "\"";
         if (label->offset != 0) out << " + " << label->offset;
         break;
       }
@@ -77,7 +65,7 @@ namespace assembler::instruction {
         break;
       case ArgumentType::Label: {
         auto *label = get_label();
-        os << label->label;
+        os << *label->label;
         if (label->offset != 0) os << "+" << label->offset;
         break;
       }
@@ -86,13 +74,8 @@ namespace assembler::instruction {
   }
 
   void Argument::set_reg_indirect(uint8_t reg, int32_t offset) {
-    destroy();
-
-    auto data = new ArgumentRegisterIndirect;
-    data->reg = reg;
-    data->offset = offset;
-
-    m_data = (uint64_t) data;
+    m_reg_indirect = {reg, offset};
+    m_data = 0;
     m_type = ArgumentType::RegisterIndirect;
   }
 
@@ -152,15 +135,13 @@ namespace assembler::instruction {
   }
 
   void Argument::update(ArgumentType type, uint64_t data) {
-    destroy();
     m_type = type;
     m_data = data;
   }
 
-  void Argument::set_label(const std::string &label, int offset, bool is_addr) {
-    destroy();
+  void Argument::set_label(const std::string *label, int offset, bool is_addr) {
+    m_label = {label, offset, is_addr};
+    m_data = 0;
     m_type = ArgumentType::Label;
-    auto ptr = new ArgumentLabel(label, offset, is_addr);
-    m_data = (uint64_t) ptr;
   }
 }
@@ -25,7 +25,7 @@ namespace assembler::instruction {
 
   /** Data structure used for representing a label. */
   struct ArgumentLabel {
-    std::string label;
+    const std::string *label; // interned label name, owned by the assembler's Data
     int offset;
     bool is_addr = false; // address if surrounded by brackets `()'
   };
@@ -35,10 +35,14 @@ namespace assembler::instruction {
     ArgumentType m_type;
     uint64_t m_data;
 
-    void destroy();
+    // stored inline, so arguments may be freely copied and never allocate
+    union {
+      ArgumentRegisterIndirect m_reg_indirect;
+      ArgumentLabel m_label;
+    };
 
   public:
-    Argument() {
+    Argument() : m_label() {
       m_type = ArgumentType::Immediate;
       m_data = 0;
     }
@@ -52,23 +56,19 @@ namespace assembler::instruction {
 
     [[nodiscard]] uint64_t get_data() const { return m_data; }
 
-    void set_data(uint64_t data) {
-      destroy();
-      m_data = data;
-    }
+    void set_data(uint64_t data) { m_data = data; }
 
-    [[nodiscard]] ArgumentLabel *get_label() const { return (ArgumentLabel *) m_data; };
+    [[nodiscard]] const ArgumentLabel *get_label() const { return &m_label; };
 
-    [[nodiscard]] ArgumentRegisterIndirect *
-    get_reg_indirect() const { return (ArgumentRegisterIndirect *) m_data; };
+    [[nodiscard]] const ArgumentRegisterIndirect *get_reg_indirect() const { return &m_reg_indirect; };
 
     void update(ArgumentType type, uint64_t data);
 
     /** Is this argument a label? */
     [[nodiscard]] bool is_label() const { return m_type == ArgumentType::Label; }
 
-    /** Set value to a label. */
-    void set_label(const std::string &label, int offset = 0, bool is_addr = false);
+    /** Set value to a label, whose name must outlive this argument. */
+    void set_label(const std::string *label, int offset = 0, bool is_addr = false);
 
     void debug_print(std::ostream &out = std::cout);
 
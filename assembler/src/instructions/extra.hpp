@@ -11,51 +11,51 @@ namespace assembler::instruction::transform {
   // generic transform -- transform reg to reg_reg
   // e.g., for use with { reg, reg_reg }
   void
-  transform_reg_reg(std::vector<std::unique_ptr<Instruction>> &instructions, std::unique_ptr<Instruction> instruction,
+  transform_reg_reg(std::vector<Instruction> &instructions, Instruction instruction,
                     int overload);
 
   // generic transform -- transform reg_val to reg_reg_val
   // e.g., for use with { reg_val, reg_reg_val }
-  void transform_reg_reg_val(std::vector<std::unique_ptr<Instruction>> &instructions,
-                             std::unique_ptr<Instruction> instruction, int overload);
+  void transform_reg_reg_val(std::vector<Instruction> &instructions,
+                             Instruction instruction, int overload);
 
   // transform last argument from <imm> to <imm: 8>
-  void transform_last_imm_to_byte(std::vector<std::unique_ptr<Instruction>> &instructions,
-                                  std::unique_ptr<Instruction> instruction, int overload);
+  void transform_last_imm_to_byte(std::vector<Instruction> &instructions,
+                                  Instruction instruction, int overload);
 
   void
-  transform_jal(std::vector<std::unique_ptr<Instruction>> &instructions, std::unique_ptr<Instruction> instruction,
+  transform_jal(std::vector<Instruction> &instructions, Instruction instruction,
                 int overload);
 
-  void branch(std::vector<std::unique_ptr<Instruction>> &instructions, std::unique_ptr<Instruction> instruction,
+  void branch(std::vector<Instruction> &instructions, Instruction instruction,
               int overload);
 
-  void exit(std::vector<std::unique_ptr<Instruction>> &instructions, std::unique_ptr<Instruction> instruction,
+  void exit(std::vector<Instruction> &instructions, Instruction instruction,
             int overload);
 
-  void interrupt(std::vector<std::unique_ptr<Instruction>> &instructions, std::unique_ptr<Instruction> instruction,
+  void interrupt(std::vector<Instruction> &instructions, Instruction instruction,
                  int overload);
 
   void
-  interrupt_return(std::vector<std::unique_ptr<Instruction>> &instructions, std::unique_ptr<Instruction> instruction,
+  interrupt_return(std::vector<Instruction> &instructions, Instruction instruction,
                    int overload);
 
-  void ret(std::vector<std::unique_ptr<Instruction>> &instructions, std::unique_ptr<Instruction> instruction, int overload);
+  void ret(std::vector<Instruction> &instructions, Instruction instruction, int overload);
 
-  void jump(std::vector<std::unique_ptr<Instruction>> &instructions, std::unique_ptr<Instruction> instruction,
+  void jump(std::vector<Instruction> &instructions, Instruction instruction,
             int overload);
 
   void
-  load_immediate(std::vector<std::unique_ptr<Instruction>> &instructions, std::unique_ptr<Instruction> instruction,
+  load_immediate(std::vector<Instruction> &instructions, Instruction instruction,
                  int overload);
 
-  void zero(std::vector<std::unique_ptr<Instruction>> &instructions, std::unique_ptr<Instruction> instruction,
+  void zero(std::vector<Instruction> &instructions, Instruction instruction,
             int overload);
 }
 
 namespace assembler::instruction::parse {
   // cvt(d1)2(d2)
   void
-  convert(const Data &data, Location &loc, std::unique_ptr<Instruction> &instruction, std::string &options,
+  convert(const Data &data, Location &loc, Instruction &instruction, std::string &options,
           message::List &msgs);
 }
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <initializer_list>
+#include <utility>
+
+namespace assembler::instruction {
+  /** List with a fixed capacity, stored inline so that it never allocates. */
+  template<typename T, uint8_t N>
+  class InlineList {
+    std::array<T, N> m_items{};
+    uint8_t m_size = 0;
+
+  public:
+    static constexpr uint8_t capacity = N;
+
+    InlineList() = default;
+
+    InlineList(std::initializer_list<T> items) {
+      for (const T &item: items) push_back(item);
+    }
+
+    [[nodiscard]] size_t size() const { return m_size; }
+
+    [[nodiscard]] bool empty() const { return m_size == 0; }
+
+    T &operator[](uint8_t i) { return m_items[i]; }
+
+    const T &operator[](uint8_t i) const { return m_items[i]; }
+
+    T &front() { return m_items[0]; }
+
+    [[nodiscard]] const T &front() const { return m_items[0]; }
+
+    T &back() { return m_items[m_size - 1]; }
+
+    [[nodiscard]] const T &back() const { return m_items[m_size - 1]; }
+
+    T *begin() { return m_items.data(); }
+
+    T *end() { return m_items.data() + m_size; }
+
+    [[nodiscard]] const T *begin() const { return m_items.data(); }
+
+    [[nodiscard]] const T *end() const { return m_items.data() + m_size; }
+
+    void push_back(T item) {
+      assert(m_size < N);
+      m_items[m_size++] = std::move(item);
+    }
+
+    template<typename... Args>
+    void emplace_back(Args &&... args) {
+      push_back(T(std::forward<Args>(args)...));
+    }
+
+    template<typename... Args>
+    void emplace_front(Args &&... args) {
+      assert(m_size < N);
+      T item(std::forward<Args>(args)...);
+
+      for (uint8_t i = m_size; i > 0; i--) {
+        m_items[i] = std::move(m_items[i - 1]);
+      }
+
+      m_items[0] = std::move(item);
+      m_size++;
+    }
+
+    void pop_back() {
+      assert(m_size > 0);
+      m_size--;
+    }
+  };
+}
@@ -50,7 +50,7 @@ namespace assembler::instruction {
     }
   }
 
-  Instruction::Instruction(const Signature *signature, std::deque<Argument> arguments) : signature(signature),
+  Instruction::Instruction(const Signature *signature, ArgumentList arguments) : signature(signature),
                                                                                          args(std::move(arguments)),
                                                                                          overload(0), test(0x0) {}
 
@@ -70,7 +70,7 @@ namespace assembler::instruction {
     }
   }
 
-  uint64_t Instruction::compile() const {
+  uint64_t Instruction::compile(std::vector<uint8_t> *arg_bounds) const {
     InstructionBuilder builder;
 
     // add opcode
@@ -95,6 +95,8 @@ namespace assembler::instruction {
       builder.data_type(0x0);
     }
 
+    if (arg_bounds) arg_bounds->push_back(builder.position());
+
     // add arguments, formatted depending on type
     for (uint8_t i = 0; i < args.size(); i++) {
       const auto &arg = args[i];
@@ -138,34 +140,22 @@ namespace assembler::instruction {
           break;
         default:;
       }
+
+      if (arg_bounds) arg_bounds->push_back(builder.position());
     }
 
     return builder.get();
   }
 
-  std::set<std::string> Instruction::get_referenced_labels() const {
-    std::set<std::string> labels;
-    for (auto& arg : args) {
-      if (arg.is_label()) {
-        labels.insert(arg.get_label()->label);
-      }
-    }
-    return labels;
-  }
+  void Instruction::resolve_label(uint8_t i, uint32_t address, bool debug) {
+    auto &arg = args[i];
 
-  void Instruction::replace_label(const std::string& label, uint32_t address, bool debug) {
-    for (uint8_t i = 0; i < args.size(); i++) {
-      auto &arg = args[i];
-
-      if (arg.is_label() && arg.get_label()->label == label) {
-        if (debug)
-          std::cout << "Replace label " << label << " with address 0x" << std::hex << address
-                    << std::dec << std::endl;
-        arg.update(signature->arguments[overload][i] == instruction::ArgumentType::Address || arg.get_label()->is_addr
-                   ? instruction::ArgumentType::Address
-                   : instruction::ArgumentType::Immediate, address + arg.get_label()->offset);
-      }
-    }
+    if (debug)
+      std::cout << "Replace label " << *arg.get_label()->label << " with address 0x" << std::hex << address
+                << std::dec << std::endl;
+    arg.update(signature->arguments[overload][i] == instruction::ArgumentType::Address || arg.get_label()->is_addr
+               ? instruction::ArgumentType::Address
+               : instruction::ArgumentType::Immediate, address + arg.get_label()->offset);
   }
 
   void InstructionBuilder::opcode(uint8_t opcode) {
@@ -11,6 +11,7 @@
 #include "constants.hpp"
 
 #include "argument.hpp"
+#include "inline_list.hpp"
 
 namespace assembler::instruction {
   struct Signature;
@@ -18,36 +19,42 @@ namespace assembler::instruction {
   /** List of all instruction signatures. Use list over map to preserve insertion order. */
   extern std::vector<Signature> signature_list;
 
+  /** Arguments of an instruction, stored inline. No signature, after transformation, takes more than this. */
+  typedef InlineList<Argument, 4> ArgumentList;
+
   class Instruction {
   public:
     const Signature *signature; // signature of instruction we are representing
     uint8_t overload = 0; // selected signature overload index, default 0
-    std::deque<Argument> args; // list of supplied arguments
+    ArgumentList args; // list of supplied arguments
 
   private:
     // conditional test bits, only included if signature.expect_test
     // MSB - perform test, or skip?
     uint8_t test;
     // datatype specifier(s), only included if signature.expect_datatype
-    std::vector<constants::inst::datatype::dt> datatypes;
+    InlineList<constants::inst::datatype::dt, 2> datatypes;
 
   public:
-    Instruction(const Signature *signature, std::deque<Argument> arguments);
+    Instruction(const Signature *signature, ArgumentList arguments);
 
     void set_conditional_test(constants::cmp::flag mask);
 
     void add_datatype_specifier(constants::inst::datatype::dt mask);
 
+    /** Is the instruction only executed if its conditional test passes? */
+    [[nodiscard]] bool is_conditional() const { return test & 0x80; }
+
+    [[nodiscard]] const InlineList<constants::inst::datatype::dt, 2> &get_datatypes() const { return datatypes; }
+
     /** Offset addresses by the given amount. */
     void offset_addresses(uint16_t offset);
 
-    /** Return set of all labels referenced in arguments. */
-    std::set<std::string> get_referenced_labels() const;
+    /** Replace the label in argument <i> with its address */
+    void resolve_label(uint8_t i, uint32_t address, bool debug = false);
 
-    /** Replace given label with its address */
-    void replace_label(const std::string& label, uint32_t address, bool debug = false);
-
-    [[nodiscard]] uint64_t compile() const;
+    /** Compile to an instruction word. If given, `arg_bounds` receives the bit position before each argument, then after the last. */
+    [[nodiscard]] uint64_t compile(std::vector<uint8_t> *arg_bounds = nullptr) const;
 
     void debug_print(std::ostream &os) const;
 
@@ -79,6 +86,9 @@ namespace assembler::instruction {
     /** Get instruction word. */
     [[nodiscard]] uint64_t get() const { return m_word; }
 
+    /** Get current bit position. */
+    [[nodiscard]] uint8_t position() const { return m_pos; }
+
     /** Specify next argument as <value>. */
     void next_as_value();
 
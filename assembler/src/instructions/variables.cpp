@@ -1,3 +1,5 @@
+#include <array>
+
 #include "constants.hpp"
 
 #include "instruction.hpp"
@@ -8,25 +10,70 @@
 namespace assembler::instruction {
   using namespace constants;
 
-  Signature *find_signature(const std::string &mnemonic, std::string &options) {
-    for (auto &signature: signature_list) {
-      if (starts_with(mnemonic, signature.mnemonic)) {
-        options = mnemonic.substr(signature.mnemonic.size());
-        return &signature;
+  /**
+   * Trie over the mnemonics of the given signatures, used to find the longest mnemonic prefixing a word in one pass.
+   * If two signatures share a mnemonic, the first is kept.
+   */
+  class MnemonicTrie {
+    struct Node {
+      std::array<uint16_t, 26> children{}; // index of the child node for each letter, 0 if none
+      Signature *signature = nullptr; // signature whose mnemonic ends at this node
+    };
+
+    std::vector<Node> m_nodes;
+
+  public:
+    explicit MnemonicTrie(std::vector<Signature> &signatures) : m_nodes(1) {
+      for (auto &signature: signatures) {
+        uint16_t node = 0;
+
+        for (char ch: signature.mnemonic) {
+          uint16_t child = m_nodes[node].children[ch - 'a'];
+
+          if (child == 0) {
+            child = m_nodes.size();
+            m_nodes[node].children[ch - 'a'] = child;
+            m_nodes.emplace_back();
+          }
+
+          node = child;
+        }
+
+        if (m_nodes[node].signature == nullptr) m_nodes[node].signature = &signature;
       }
     }
 
-    return nullptr;
-  }
+    /** Return the signature with the longest mnemonic which prefixes `word`, setting `length` to its length. */
+    Signature *find(const std::string &word, size_t &length) const {
+      Signature *signature = nullptr;
+      uint16_t node = 0;
 
-  Signature *find_signature(const std::string &mnemonic) {
-    for (auto &signature: signature_list) {
-      if (starts_with(mnemonic, signature.mnemonic)) {
-        return &signature;
+      for (size_t i = 0; i < word.size() && word[i] >= 'a' && word[i] <= 'z'; i++) {
+        node = m_nodes[node].children[word[i] - 'a'];
+        if (node == 0) break;
+
+        if (m_nodes[node].signature) {
+          signature = m_nodes[node].signature;
+          length = i + 1;
+        }
       }
+
+      return signature;
     }
+  };
 
-    return nullptr;
+  Signature *find_signature(const std::string &mnemonic, std::string &options) {
+    static const MnemonicTrie trie(signature_list);
+    size_t length;
+    Signature *signature = trie.find(mnemonic, length);
+
+    if (signature) options = mnemonic.substr(length);
+    return signature;
+  }
+
+  Signature *find_signature(const std::string &mnemonic) {
+    std::string options;
+    return find_signature(mnemonic, options);
   }
 
   const std::deque reg_val = {ArgumentType::Register, ArgumentType::Value};
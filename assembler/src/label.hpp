@@ -1,8 +1,27 @@
 #pragma once
 
+#include <cstdint>
+#include <string>
+
 namespace assembler {
   struct Label {
     Location loc;
     uint64_t addr = 0;
   };
+
+  /** Reference to a label from an instruction argument, patched once the label is declared. */
+  struct Fixup {
+    uint32_t instruction; // Index of the instruction in the chunk buffer
+    uint8_t arg; // Index of the argument
+  };
+
+  /** Reference to a label, recorded when assembling a relocatable object so the linker may patch it. */
+  struct Reference {
+    std::string label;
+    int64_t addend; // Offset added to the label's address
+    uint32_t offset; // Offset of the referencing chunk, or of the field itself for data
+    int64_t instruction; // Index of the referencing instruction in the chunk buffer, or -1 for data
+    uint8_t arg; // Index of the argument, or size of the field in bytes for data
+    uint32_t line; // Index of the referencing source line
+  };
 }
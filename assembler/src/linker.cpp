@@ -0,0 +1,171 @@
+#include "linker.hpp"
+
+#include <unordered_map>
+#include <unordered_set>
+
+#include "constants.hpp"
+
+namespace assembler::linker {
+  /** Location of a defined symbol. */
+  struct Definition {
+    size_t input; // index of the defining input
+    uint32_t symbol; // index into the input's symbols
+  };
+
+  /** Locate the given source in an input. */
+  static Location locate(const Input &input, const object::Source &source) {
+    return input.object.location(source, input.path);
+  }
+
+  /** Add global symbols defined by the input to the symbol table, return false on a duplicate definition. */
+  static bool define_symbols(const std::vector<Input> &inputs, size_t index,
+                             std::unordered_map<std::string, Definition> &symbols, message::List &msgs) {
+    bool ok = true;
+
+    const auto &defined = inputs[index].object.symbols;
+
+    for (uint32_t i = 0; i < defined.size(); i++) {
+      const object::Symbol &symbol = defined[i];
+      if (!symbol.defined || !symbol.global) continue;
+
+      if (auto [it, inserted] = symbols.insert({symbol.name, {index, i}}); !inserted) {
+        auto msg = std::make_unique<message::Message>(message::Error, locate(inputs[index], symbol.source));
+        msg->get() << "duplicate definition of symbol " << symbol.name;
+        msgs.add(std::move(msg));
+
+        const Input &previous = inputs[it->second.input];
+        msg = std::make_unique<message::Message>(message::Note,
+                                                 locate(previous, previous.object.symbols[it->second.symbol].source));
+        msg->get() << "previously defined here";
+        msgs.add(std::move(msg));
+        ok = false;
+      }
+    }
+
+    return ok;
+  }
+
+  bool link(const std::vector<Input> &inputs, std::ostream &os, message::List &msgs, bool debug) {
+    std::unordered_map<std::string, Definition> symbols;
+    std::vector<bool> included(inputs.size());
+    std::unordered_set<std::string> referenced; // symbols referenced by an included object
+    bool ok = true;
+
+    auto include = [&](size_t i) {
+      included[i] = true;
+      ok &= define_symbols(inputs, i, symbols, msgs);
+
+      for (const object::Symbol &symbol: inputs[i].object.symbols) {
+        if (!symbol.defined) referenced.insert(symbol.name);
+      }
+    };
+
+    // objects are always linked
+    for (size_t i = 0; i < inputs.size(); i++) {
+      if (!inputs[i].library) include(i);
+    }
+
+    // pull in libraries which define an undefined symbol, until no more are needed
+    for (bool changed = true; changed;) {
+      changed = false;
+
+      for (size_t i = 0; i < inputs.size(); i++) {
+        if (included[i]) continue;
+
+        for (const object::Symbol &symbol: inputs[i].object.symbols) {
+          if (!symbol.defined || !symbol.global || symbols.contains(symbol.name) || !referenced.contains(symbol.name))
+            continue;
+
+          if (debug)
+            std::cout << "link library " << inputs[i].path << " for symbol " << symbol.name << std::endl;
+
+          include(i);
+          changed = true;
+          break;
+        }
+      }
+    }
+
+    // assign each included object a base address
+    std::vector<uint64_t> bases(inputs.size());
+    uint64_t size = 0;
+
+    for (size_t i = 0; i < inputs.size(); i++) {
+      if (!included[i]) continue;
+
+      size = (size + 7) & ~7ull;
+      bases[i] = size;
+      size += inputs[i].object.image.size();
+
+      if (debug)
+        std::cout << "object " << inputs[i].path << " at 0x" << std::hex << bases[i] << " of 0x"
+                  << inputs[i].object.image.size() << std::dec << " bytes" << std::endl;
+    }
+
+    auto address_of = [&](const Definition &definition) {
+      return bases[definition.input] + inputs[definition.input].object.symbols[definition.symbol].offset;
+    };
+
+    std::vector<uint8_t> image(size);
+
+    for (size_t i = 0; i < inputs.size(); i++) {
+      if (!included[i]) continue;
+
+      const object::Object &object = inputs[i].object;
+      std::copy(object.image.begin(), object.image.end(), image.begin() + (long) bases[i]);
+
+      for (const object::Relocation &relocation: object.relocations) {
+        const object::Symbol &symbol = object.symbols[relocation.symbol];
+        const std::string &name = symbol.name;
+        Definition definition{i, relocation.symbol};
+
+        // symbols defined by this object, global or not, are its own, others must be global in another object
+        if (!symbol.defined) {
+          auto it = symbols.find(name);
+
+          if (it == symbols.end()) {
+            auto msg = std::make_unique<message::Message>(message::Error, locate(inputs[i], relocation.source));
+            msg->get() << "undefined reference to symbol " << name;
+            msgs.add(std::move(msg));
+            ok = false;
+            continue;
+          }
+
+          definition = it->second;
+        }
+
+        uint64_t value = address_of(definition) + relocation.addend;
+        object::Relocation placed = relocation;
+        placed.offset += bases[i];
+
+        if (!object::patch(image, placed, value)) {
+          auto msg = std::make_unique<message::Message>(message::Error, locate(inputs[i], relocation.source));
+          msg->get() << "address 0x" << std::hex << value << std::dec << " of symbol " << name
+                     << " does not fit in " << (int) relocation.width << " bits";
+          msgs.add(std::move(msg));
+          ok = false;
+        }
+      }
+    }
+
+    if (!ok) return false;
+
+    // write header: entry point and interrupt handler
+    auto symbol = symbols.find("main");
+    uint64_t value = symbol == symbols.end() ? 0 : address_of(symbol->second);
+    os.write((char *) &value, sizeof(value));
+
+    if (debug)
+      std::cout << "start address: 0x" << std::hex << value << std::dec << std::endl;
+
+    symbol = symbols.find("interrupt_handler");
+    value = symbol == symbols.end() ? constants::default_interrupt_handler : address_of(symbol->second);
+    os.write((char *) &value, sizeof(value));
+
+    if (debug)
+      std::cout << "interrupt handler address: 0x" << std::hex << value << std::dec << std::endl;
+
+    os.write((const char *) image.data(), (std::streamsize) image.size());
+    return true;
+  }
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <filesystem>
+#include <iostream>
+#include <vector>
+
+#include "messages/list.hpp"
+#include "object.hpp"
+
+namespace assembler::linker {
+  /** An object to be linked. */
+  struct Input {
+    std::filesystem::path path;
+    object::Object object;
+    bool library = false; // only linked if it defines a symbol which is otherwise undefined
+  };
+
+  /**
+   * Link the given objects into a binary, written to the output stream. Objects are laid out in order, each aligned
+   * to 8 bytes. Return false if an error was added, e.g. on a duplicate or undefined symbol.
+   */
+  bool link(const std::vector<Input> &inputs, std::ostream &os, message::List &msgs, bool debug = false);
+}
@@ -0,0 +1,127 @@
+#include "object.hpp"
+
+#include <cstring>
+
+#include "serialise.hpp"
+
+namespace assembler::object {
+  using namespace serialise;
+
+  static void write_source(std::ostream &os, const Source &source) {
+    write_value(os, source.file);
+    write_value(os, source.line);
+  }
+
+  /** Read a source, return success if it is unknown or locates a line in one of <file_count> files. */
+  static bool read_source(std::istream &is, Source &source, size_t file_count) {
+    return read_value(is, source.file) && read_value(is, source.line)
+           && (source.file == no_file || source.file < file_count);
+  }
+
+  Location Object::location(const Source &source, const std::filesystem::path &path) const {
+    if (source.file == no_file) return Location(path);
+    return Location(files[source.file], source.line);
+  }
+
+  void Object::write(std::ostream &os) const {
+    os.write(magic, sizeof(magic));
+    write_value(os, version);
+
+    write_value<uint64_t>(os, image.size());
+    os.write((const char *) image.data(), (std::streamsize) image.size());
+
+    write_value<uint32_t>(os, files.size());
+    for (const std::string &file: files) {
+      write_string(os, file);
+    }
+
+    write_value<uint32_t>(os, symbols.size());
+    for (const Symbol &symbol: symbols) {
+      write_string(os, symbol.name);
+      write_value<uint8_t>(os, symbol.defined);
+      write_value<uint8_t>(os, symbol.global);
+      write_value(os, symbol.offset);
+      write_source(os, symbol.source);
+    }
+
+    write_value<uint32_t>(os, relocations.size());
+    for (const Relocation &relocation: relocations) {
+      write_value(os, relocation.offset);
+      write_value(os, relocation.bit);
+      write_value(os, relocation.width);
+      write_value(os, relocation.symbol);
+      write_value(os, relocation.addend);
+      write_source(os, relocation.source);
+    }
+  }
+
+  bool Object::read(std::istream &is) {
+    char file_magic[sizeof(magic)];
+    uint32_t file_version;
+
+    if (!is.read(file_magic, sizeof(file_magic)) || std::memcmp(file_magic, magic, sizeof(magic)) != 0
+        || !read_value(is, file_version) || file_version != version) {
+      return false;
+    }
+
+    uint64_t image_size;
+    if (!read_value(is, image_size)) return false;
+
+    image.resize(image_size);
+    if (!is.read((char *) image.data(), (std::streamsize) image_size)) return false;
+
+    uint32_t count;
+    if (!read_value(is, count)) return false;
+
+    files.resize(count);
+    for (std::string &file: files) {
+      if (!read_string(is, file)) return false;
+    }
+
+    if (!read_value(is, count)) return false;
+
+    symbols.resize(count);
+    for (Symbol &symbol: symbols) {
+      uint8_t defined, global;
+      if (!read_string(is, symbol.name) || !read_value(is, defined) || !read_value(is, global)
+          || !read_value(is, symbol.offset) || !read_source(is, symbol.source, files.size()))
+        return false;
+
+      symbol.defined = defined;
+      symbol.global = global;
+    }
+
+    if (!read_value(is, count)) return false;
+
+    relocations.resize(count);
+    for (Relocation &relocation: relocations) {
+      if (!read_value(is, relocation.offset) || !read_value(is, relocation.bit) || !read_value(is, relocation.width)
+          || !read_value(is, relocation.symbol) || !read_value(is, relocation.addend)
+          || !read_source(is, relocation.source, files.size())) {
+        return false;
+      }
+
+      // reject relocations outside of the image or symbol table
+      if (relocation.symbol >= symbols.size() || relocation.width == 0 || relocation.width > 64
+          || relocation.offset * 8 + relocation.bit + relocation.width > image.size() * 8) {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  bool patch(std::vector<uint8_t> &image, const Relocation &relocation, uint64_t value) {
+    uint64_t mask = relocation.width == 64 ? ~0ull : (1ull << relocation.width) - 1;
+
+    // write field bit-by-bit, as it may straddle bytes
+    for (uint8_t i = 0; i < relocation.width; i++) {
+      uint64_t bit = relocation.offset * 8 + relocation.bit + i;
+      uint8_t &byte = image[bit / 8];
+      byte = (byte & ~(1 << bit % 8)) | ((value >> i & 1) << bit % 8);
+    }
+
+    // value must be representable in the field, as either a signed or unsigned integer
+    return (value & ~mask) == 0 || ((~value & ~mask) == 0 && (value >> (relocation.width - 1) & 1));
+  }
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "location.hpp"
+
+namespace assembler::object {
+  // first bytes of every object file
+  constexpr char magic[4] = {'E', 'O', 'B', 'J'};
+  constexpr uint32_t version = 3;
+
+  // file index of an unknown source
+  constexpr uint32_t no_file = 0xffffffff;
+
+  /** Source line of a symbol's declaration or a relocation's reference, for diagnostics. */
+  struct Source {
+    uint32_t file = no_file; // index into the object's files
+    int32_t line = -1;
+  };
+
+  /**
+   * Symbol defined or referenced by an object. Every label is a symbol, but only global symbols are visible to other
+   * objects, so references to undefined symbols are resolved against those.
+   */
+  struct Symbol {
+    std::string name;
+    bool defined; // defined in this object, or referenced from it?
+    bool global = false; // visible to other objects, if defined?
+    uint64_t offset = 0; // byte offset into the image, if defined
+    Source source; // declaration, if defined
+  };
+
+  /** Field in the image which must be patched with the address of a symbol, plus an addend, once it is known. */
+  struct Relocation {
+    uint64_t offset; // byte offset into the image
+    uint8_t bit; // bit offset of the field, from the little-endian word starting at `offset`
+    uint8_t width; // width of the field in bits
+    uint32_t symbol; // index into the symbol table
+    int64_t addend;
+    Source source; // referencing line
+  };
+
+  /** A relocatable object: an image assembled as if loaded at address 0, with symbol and relocation tables. */
+  struct Object {
+    std::vector<uint8_t> image;
+    std::vector<std::string> files; // source files, which symbols and relocations are located in
+    std::vector<Symbol> symbols;
+    std::vector<Relocation> relocations;
+
+    /** Locate the given source, or the object itself at <path> if it is unknown. */
+    [[nodiscard]] Location location(const Source &source, const std::filesystem::path &path) const;
+
+    /** Write object to output stream. */
+    void write(std::ostream &os) const;
+
+    /** Read object from input stream, return success. */
+    bool read(std::istream &is);
+
+  };
+
+  /** Write `value` into the field described by the relocation, return false if it does not fit. */
+  bool patch(std::vector<uint8_t> &image, const Relocation &relocation, uint64_t value);
+}
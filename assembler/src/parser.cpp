@@ -7,6 +7,9 @@
 
 #include "util.hpp"
 #include "constants.hpp"
+#include "peephole.hpp"
+#include "dead_code.hpp"
+#include "expression.hpp"
 
 namespace assembler::parser {
   void emit_ch(std::ostream &os, const std::string &s, int i) {
@@ -19,6 +22,10 @@ namespace assembler::parser {
   void parse(Data &data, message::List &msgs) {
     data.offset = 0;
 
+    // re-used for each line, so parsing an instruction does not allocate once these have grown
+    std::vector<instruction::Argument> arguments;
+    std::vector<instruction::Instruction> instructions;
+
     for (int line_idx = 0; line_idx < data.lines.size(); line_idx++) {
       const auto &line = data.lines[line_idx];
       Location loc = line.first;
@@ -91,8 +98,8 @@ namespace assembler::parser {
           label->second.addr = data.offset;
         }
 
-        // Replace all past references with its address
-        data.replace_label(label_name, data.offset);
+        // Patch all past references with its address once placed, as it may yet be aligned
+        data.pending_labels.push_back(label_name);
 
         // End of input?
         if (i == line.second.size()) {
@@ -122,7 +129,7 @@ namespace assembler::parser {
       }
 
       // structure to accumulate parsed arguments
-      std::deque<instruction::Argument> arguments;
+      arguments.clear();
 
       while (i < line.second.size()) {
         skip_whitespace(line.second, i);
@@ -163,9 +170,9 @@ namespace assembler::parser {
       }
 
       // parse instruction
-      std::vector<std::unique_ptr<instruction::Instruction>> instructions;
+      instructions.clear();
       loc.column(start);
-      bool ok = parse_instruction(data, loc, msgs, mnemonic, arguments, instructions);
+      bool ok = parse_instruction(data, loc, msgs, signature, options, arguments, instructions);
 
       // check if error occurred
       // - if so, add arguments as note
@@ -197,30 +204,60 @@ namespace assembler::parser {
 
       // go through each instruction
       for (auto &instruction: instructions) {
-        // resolve labels
-        auto labels = instruction->get_referenced_labels();
-        for (const std::string& label : labels) {
-          // replace the label if possible
-          if (auto it = data.labels.find(label); it != data.labels.end()) {
-            instruction->replace_label(label, it->second.addr, data.cli_args.debug);
-          }
-        }
+        // insert into buffer, then resolve labels, or record a fixup to be patched once declared
+        uint32_t index = data.add_instruction(line_idx, std::move(instruction));
+        data.resolve_references(index);
+      }
+    }
+
+    // labels at the end label nothing
+    data.place_labels();
+
+    // chunks past the end of the address space would wrap over the start
+    if (data.overflow_line >= 0) {
+      auto msg = std::make_unique<message::Message>(message::Error, data.lines[data.overflow_line].first);
+      msg->get() << "program exceeds the 32-bit address space";
+      msgs.add(std::move(msg));
+      return;
+    }
 
-        // create a Chunk and insert
-        data.add_chunk(std::make_unique<InstructionChunk>(line.first, data.offset, std::move(instruction)));
+    // labels left undeclared in a relocatable object are left for the linker, so zero their fields
+    if (data.cli_args.relocatable) {
+      for (const auto &[label, fixups]: data.fixups) {
+        for (const Fixup &fixup: fixups) {
+          data.buffer.instruction(fixup.instruction).resolve_label(fixup.arg, 0, data.cli_args.debug);
+        }
       }
+
+      data.fixups.clear();
     }
 
-    // check if any labels left...
-    for (auto &chunk: data.buffer) {
-      auto label = chunk->get_first_label();
+    // check if any labels left, reporting the first in the buffer
+    if (!data.fixups.empty()) {
+      for (auto &chunk: data.buffer) {
+        auto label = data.buffer.get_first_label(chunk);
 
-      if (label) {
-        auto msg = std::make_unique<message::Message>(message::Error, chunk->location());
-        msg->get() << "unresolved reference to label " << label->label;
-        msgs.add(std::move(msg));
-        return;
+        if (label) {
+          auto msg = std::make_unique<message::Message>(message::Error, data.location(chunk));
+          msg->get() << "unresolved reference to label " << *label->label;
+          msgs.add(std::move(msg));
+          return;
+        }
+      }
+    }
+
+    // optimise, now that every label is declared
+    if (data.cli_args.optimise) {
+      // a relocatable object's labels may be referenced by other objects
+      if (!data.cli_args.relocatable) {
+        if (uint32_t removed_bytes = dead_code::eliminate(data); removed_bytes > 0) {
+          auto msg = std::make_unique<message::BasicMessage>(message::Note);
+          msg->get() << "dead code elimination removed " << removed_bytes << " byte(s)";
+          msgs.add(std::move(msg));
+        }
       }
+
+      peephole::optimise(data);
     }
 
     // reconstruct assembly?
@@ -230,9 +267,34 @@ namespace assembler::parser {
   }
 
   bool parse_directive(Data &data, Location &loc, int line_idx, const std::string &directive, message::List &msgs) {
-    if (directive == "byte" || directive == "data" || directive == "word") {
-      uint8_t size = directive == "byte" ? 1 : directive == "word" ? 8 : 4;
+    auto &line = data.lines[line_idx];
+
+    if (directive == "byte" || directive == "data" || directive == "word" || directive == "const") {
+      // ".const <directive> ..." is read-only data, which may be merged with an identical copy
+      bool is_const = directive == "const";
+      std::string kind = directive;
+
+      if (is_const) {
+        int &col = loc.columnref();
+        int start = col;
+        skip_alpha(line.second, col);
+        kind = line.second.substr(start, col - start);
+
+        if (kind != "byte" && kind != "data" && kind != "word") {
+          auto msg = std::make_unique<message::Message>(message::Error, loc.copy().column(start));
+          msg->get() << ".const: expected byte, data or word, got '" << kind << "'";
+          msgs.add(std::move(msg));
+          return false;
+        }
+      }
+
+      uint8_t size = kind == "byte" ? 1 : kind == "word" ? 8 : 4;
       std::vector<uint8_t> bytes;
+      size_t first_reference = data.references.size();
+
+      // align to the unit size first, so fields referencing pending labels hold their final address
+      uint32_t extent = data.buffer.extent();
+      uint32_t padding = data.align(line_idx, loc.column(), size);
 
       if (!parse_data(data, loc, line_idx, size, msgs, bytes)) {
         return false;
@@ -245,45 +307,132 @@ namespace assembler::parser {
         }
       }
 
+      // only labelled constants are pooled, so a copy always starts a label's region, and the key includes the unit
+      // size, so a copy is always aligned
+      if (is_const && !data.pending_labels.empty()) {
+        std::string key(1, (char) size);
+        key.append(bytes.begin(), bytes.end());
+
+        // labels of a copy are redirected to the first copy, unlabelled data may be reached from a previous label
+        if (auto copy = data.constant_pool.find(key); copy != data.constant_pool.end()) {
+          if (data.cli_args.debug)
+            std::cout << loc << " .const: merged " << bytes.size() << " bytes with copy at 0x" << std::hex
+                      << copy->second << std::dec << std::endl;
+
+          // nothing is written here, so neither is the padding
+          if (padding > 0) data.unalign(padding, extent);
+
+          for (const std::string &name: data.pending_labels) {
+            data.labels.find(name)->second.addr = copy->second;
+          }
+
+          data.place_labels();
+          data.references.erase(data.references.begin() + (long) first_reference, data.references.end());
+          return true;
+        }
+
+        data.constant_pool.insert({std::move(key), data.offset});
+      }
+
       if (data.cli_args.debug) {
         std::cout << loc << " ." << directive << ": size " << bytes.size() << " bytes" << std::endl;
       }
 
       // insert buffer into a Chunk
-      data.offset += bytes.size();
-      data.buffer.push_back(std::make_unique<DataChunk>(loc, data.offset, std::move(bytes)));
+      data.add_data(line_idx, loc.column(), bytes);
 
       return true;
     }
 
-    auto &line = data.lines[line_idx];
+    if (directive == "global") {
+      // each label listed is exported from a relocatable object, others are local to it
+      int col = loc.column(), count = 0;
+
+      while (true) {
+        skip_whitespace(line.second, col);
+        if (col >= line.second.size()) break;
+
+        int start = col;
+        while (col < line.second.size() && line.second[col] != ' ' && line.second[col] != ',') col++;
+        std::string name = line.second.substr(start, col - start);
+
+        if (!is_valid_label_name(name)) {
+          auto msg = std::make_unique<message::Message>(message::Error, loc.copy().column(start));
+          msg->get() << ".global: invalid label '" << name << "'";
+          msgs.add(std::move(msg));
+          return false;
+        }
 
-    if (directive == "space" || directive == "org") {
+        if (data.cli_args.debug)
+          std::cout << loc << " .global: export label " << name << std::endl;
+
+        data.globals.insert(name);
+        count++;
+        if (col < line.second.size() && line.second[col] == ',') col++;
+      }
+
+      if (count == 0) {
+        auto msg = std::make_unique<message::Message>(message::Error, loc);
+        msg->get() << ".global: expected a label";
+        msgs.add(std::move(msg));
+        return false;
+      }
+
+      return true;
+    }
+
+    if (directive == "space" || directive == "org" || directive == "align") {
       int col = loc.column();
       skip_whitespace(line.second, col);
 
-      uint64_t value;
-      bool is_double;
-      if (!parse_number(line.second, col, value, is_double)) {
-        auto msg = std::make_unique<message::Message>(message::Error, loc.copy().column(col));
-        msg->get() << "expected number";
-        msgs.add(std::move(msg));
+      int start = col;
+      expression::Value expr;
+      if (!expression::parse(line.second, col, loc, msgs, expr)) {
         return false;
       }
 
-      if (is_double) {
-        auto msg = std::make_unique<message::Message>(message::Error, loc.copy().column(col));
+      if (expr.is_decimal) {
+        auto msg = std::make_unique<message::Message>(message::Error, loc.copy().column(start));
         msg->get() << "number of bytes cannot be decimal!";
         msgs.add(std::move(msg));
         return false;
       }
 
+      if (!expr.label.empty()) {
+        auto msg = std::make_unique<message::Message>(message::Error, loc.copy().column(start));
+        msg->get() << "." << directive << " expects a constant, got label " << expr.label;
+        msgs.add(std::move(msg));
+        return false;
+      }
+
+      uint64_t value = expr.value;
+
+      if (directive != "align" && value > UINT32_MAX) {
+        auto msg = std::make_unique<message::Message>(message::Error, loc.copy().column(start));
+        msg->get() << "." << directive << ": 0x" << std::hex << value << std::dec
+                   << " exceeds the 32-bit address space";
+        msgs.add(std::move(msg));
+        return false;
+      }
+
       if (directive == "space") {
         if (data.cli_args.debug)
           std::cout << loc << " .space: insert " << value << " null bytes" << std::endl;
 
         // add chunk to data (this will increase data.offset)
-        data.add_chunk(std::make_unique<SpaceDirectiveChunk>(loc, data.offset, value));
+        data.add_space(line_idx, loc.column(), value);
+      } else if (directive == "align") {
+        if (value == 0 || value > UINT32_MAX) {
+          auto msg = std::make_unique<message::Message>(message::Error, loc.copy().column(start));
+          msg->get() << ".align: alignment must be positive, got " << value;
+          msgs.add(std::move(msg));
+          return false;
+        }
+
+        uint32_t padding = data.align(line_idx, loc.column(), value);
+
+        if (data.cli_args.debug)
+          std::cout << loc << " .align: insert " << padding << " null bytes" << std::endl;
       } else {
         if (data.cli_args.debug)
           std::cout << loc << " .org: move from 0x" << std::hex << data.offset << " to 0x"
@@ -296,8 +445,12 @@ namespace assembler::parser {
           msgs.add(std::move(msg));
         }
 
+        // labels before the .org keep their offset
+        data.place_labels();
+
         // set offset as specified
         data.offset = value;
+        data.origins.push_back(value);
       }
 
       return true;
@@ -306,19 +459,47 @@ namespace assembler::parser {
     return false;
   }
 
+  void report_no_overload(const Location &loc, message::List &msgs, const instruction::Signature *signature,
+                          const std::vector<instruction::Argument> &arguments) {
+    auto msg = std::make_unique<message::Message>(message::Error, loc);
+    auto &stream = msg->get();
+    stream << "no match for mnemonic " << signature->mnemonic << " with arguments ";
+
+    for (auto &arg: arguments) {
+      stream << instruction::Argument::type_to_string(arg.get_type()) << " ";
+    }
+
+    stream << "- available overloads:";
+
+    for (auto &args: signature->arguments) {
+      stream << std::endl << "\t- " << signature->mnemonic;
+
+      if (!args.empty()) {
+        for (auto &arg: args) {
+          stream << " " << instruction::Argument::type_to_string(arg);
+        }
+      }
+    }
+
+    msgs.add(std::move(msg));
+  }
+
   bool parse_instruction(const Data &data, Location &loc, message::List &msgs,
-                         const std::string &mnemonic,
-                         const std::deque<instruction::Argument> &arguments,
-                         std::vector<std::unique_ptr<instruction::Instruction>> &instructions) {
-    // lookup signature, create instruction from it with args provided
-    std::string options;
-    auto signature = instruction::find_signature(mnemonic, options);
-
-    if (signature == nullptr) {
+                         const instruction::Signature *signature, std::string options,
+                         const std::vector<instruction::Argument> &arguments,
+                         std::vector<instruction::Instruction> &instructions) {
+    // no overload takes more arguments than an instruction can hold
+    if (arguments.size() > instruction::ArgumentList::capacity) {
+      report_no_overload(loc, msgs, signature, arguments);
       return false;
     }
 
-    auto instruction = std::make_unique<instruction::Instruction>(signature, arguments);
+    // create instruction from signature with args provided
+    instruction::Instruction instruction(signature, {});
+
+    for (const auto &argument: arguments) {
+      instruction.args.push_back(argument);
+    }
 
     // custom parser?
     if (signature->parse) {
@@ -352,7 +533,7 @@ namespace assembler::parser {
                     << str.substr(0, i) << "')\n";
         }
 
-        instruction->set_conditional_test(mask.value());
+        instruction.set_conditional_test(mask.value());
       }
     } else if (!options.empty() && dot == std::string::npos) {
       auto msg = std::make_unique<message::Message>(message::Error, loc);
@@ -363,7 +544,7 @@ namespace assembler::parser {
 
     if (signature->expect_datatype) {
       if (dot == std::string::npos) {
-        instruction->add_datatype_specifier(constants::inst::datatype::u64);
+        instruction.add_datatype_specifier(constants::inst::datatype::u64);
       } else {
         std::string str = options.substr(dot + 1);
         auto dt = constants::inst::datatype::map.find(str);
@@ -375,7 +556,7 @@ namespace assembler::parser {
           return false;
         }
 
-        instruction->add_datatype_specifier(dt->second);
+        instruction.add_datatype_specifier(dt->second);
       }
     } else if (dot != std::string::npos) {
       auto msg = std::make_unique<message::Message>(message::Error, loc);
@@ -395,7 +576,7 @@ namespace assembler::parser {
       bool ok = true;
 
       for (int i = 0; i < signature->arguments[k].size(); i++) {
-        if (!instruction->args[i].type_match(signature->arguments[k][i])) {
+        if (!instruction.args[i].type_match(signature->arguments[k][i])) {
           ok = false;
           break;
         }
@@ -408,32 +589,12 @@ namespace assembler::parser {
     }
 
     if (overload == -1) {
-      auto msg = std::make_unique<message::Message>(message::Error, loc);
-      auto &stream = msg->get();
-      stream << "no match for mnemonic " << signature->mnemonic << " with arguments ";
-
-      for (auto &arg: arguments) {
-        stream << instruction::Argument::type_to_string(arg.get_type()) << " ";
-      }
-
-      stream << "- available overloads:";
-
-      for (auto &args: signature->arguments) {
-        stream << std::endl << "\t- " << signature->mnemonic;
-
-        if (!args.empty()) {
-          for (auto &arg: args) {
-            stream << " " << instruction::Argument::type_to_string(arg);
-          }
-        }
-      }
-
-      msgs.add(std::move(msg));
+      report_no_overload(loc, msgs, signature, arguments);
       return false;
     }
 
     // store overload
-    instruction->overload = overload;
+    instruction.overload = overload;
 
     // call custom handler if supplied
     if (signature->intercept == nullptr) {
@@ -445,7 +606,7 @@ namespace assembler::parser {
     return true;
   }
 
-  bool parse_data(const Data &data, Location &loc, int line_idx, uint8_t size, message::List &msgs, std::vector<uint8_t> &bytes) {
+  bool parse_data(Data &data, Location &loc, int line_idx, uint8_t size, message::List &msgs, std::vector<uint8_t> &bytes) {
     auto &line = data.lines[line_idx];
 
     int str_start = -1; // index of string start, or -1 if not in string
@@ -477,35 +638,39 @@ namespace assembler::parser {
         } else {
           value = (uint8_t) line.second[col++];
         }
-      } else if (line.second[col] == '\'') {
-        // character literal
-        col++;
-        parse_character_literal(data, loc, line_idx, msgs, value);
+      } else {
+        // expression, e.g., a number, character literal or label
+        int start = col;
+        expression::Value expr;
 
-        if (msgs.has_message_of(message::Error)) {
+        if (!expression::parse(line.second, col, loc, msgs, expr)) {
           return false;
         }
-      } else if (parse_number(line.second, col, value, is_decimal)) {
-        // numeric literal
-      } else {
-        // extract context until space or comma
-        int start = col;
-        skip_to_break(line.second, col);
-        const std::string extracted = line.second.substr(start, col - start);
 
-        // check if a label
-        if (auto it = data.labels.find(extracted); it != data.labels.end()) {
-          value = it->second.addr;
-        } else {
-          col = start;
-          std::unique_ptr<message::BasicMessage> msg = std::make_unique<message::Message>(message::Error, loc);
-          msg->get() << "unexpected character '" << line.second[col] << "' in data list";
-          msgs.add(std::move(msg));
+        value = expr.value;
+        is_decimal = expr.is_decimal;
 
-          msg = std::make_unique<message::BasicMessage>(message::Note);
-          msg->get() << "labels cannot be used prior to declaration in this context";
-          msgs.add(std::move(msg));
-          return false;
+        // labels must have been declared
+        if (!expr.label.empty()) {
+          auto it = data.labels.find(expr.label);
+
+          if (it == data.labels.end()) {
+            std::unique_ptr<message::BasicMessage> msg = std::make_unique<message::Message>(message::Error, loc.copy().column(start));
+            msg->get() << "unknown label '" << expr.label << "' in data list";
+            msgs.add(std::move(msg));
+
+            msg = std::make_unique<message::BasicMessage>(message::Note);
+            msg->get() << "labels cannot be used prior to declaration in this context";
+            msgs.add(std::move(msg));
+            return false;
+          }
+
+          value += it->second.addr;
+
+          if (data.cli_args.relocatable || data.cli_args.optimise) {
+            data.references.push_back({expr.label, (int64_t) expr.value, uint32_t(data.offset + bytes.size()), -1, size,
+                                       (uint32_t) line_idx});
+          }
         }
       }
 
@@ -553,31 +718,11 @@ namespace assembler::parser {
     return true;
   }
 
-  void parse_arg(const Data &data, Location &loc, int line_idx, message::List &msgs, instruction::Argument &argument) {
+  void parse_arg(Data &data, Location &loc, int line_idx, message::List &msgs, instruction::Argument &argument) {
     auto &line = data.lines[line_idx];
     int &col = loc.columnref();
     int start;
 
-    // store value - this is used for both immediate and register indirect
-    uint64_t value = 0;
-    bool found_number = false;
-    bool number_decimal = false; // was source of `value` a decimal?
-
-    // immediate - character literal
-    if (line.second[col] == '\'') {
-      col++;
-      parse_character_literal(data, loc, line_idx, msgs, value);
-
-      // Any errors?
-      if (msgs.has_message_of(message::Error)) {
-        return;
-      }
-
-      // Update argument
-      argument.update(instruction::ArgumentType::Immediate, value);
-      return;
-    }
-
     // register?
     if (line.second[col] == '$') {
       start = col++;
@@ -596,66 +741,52 @@ namespace assembler::parser {
       return;
     }
 
-    // label?
-    if (std::isalpha(line.second[col])) {
-      // extract label
-      start = col;
-      skip_to_break(line.second, col);
-      auto label = line.second.substr(start, col - start);
-      col++;
+    // otherwise, an expression: an immediate or label, or the offset of a register indirect or address
+    // `($reg)` has no offset
+    expression::Value value;
+    start = col;
 
-      // do we have an offset
-      skip_whitespace(line.second, col);
-      int offset = 0;
-      if (line.second[col] == '+' || line.second[col] == '-') {
-        bool negate = line.second[col] == '-';
-        col++;
-        skip_whitespace(line.second, col);
-        start = col;
+    if (line.second[col] != '(' || line.second[col + 1] != '$') {
+      if (!expression::parse(line.second, col, loc, msgs, value)) return;
 
-        // parse number
-        if (parse_number(line.second, col, value, number_decimal)) {
-          offset = value;
-          if (negate) offset *= -1;
-        } else {
+      // a lone group is an address
+      if (value.is_group) {
+        if (value.is_decimal) {
           auto msg = std::make_unique<message::Message>(message::Error, loc.copy().column(start));
-          msg->get() << "expected number as label offset";
+          msg->get() << "memory address cannot be a decimal!";
           msgs.add(std::move(msg));
           return;
         }
-      }
-
-      argument.set_label(label, offset);
-      return;
-    }
 
-    // if integer, parse it
-    // this could be immediate, or register indirect
-    if (line.second[col] == '-' || std::isdigit(line.second[col])) {
-      start = col;
+        if (value.label.empty()) {
+          argument.update(instruction::ArgumentType::Address, value.value);
+        } else {
+          argument.set_label(data.intern(value.label), (int) value.value, true);
+        }
 
-      // parse number
-      if (parse_number(line.second, col, value, number_decimal)) {
-        // mark as found... this could become a register indirect!
-        found_number = true;
-      } else {
-        // too bad, continue to parse
-        col = start;
+        return;
       }
     }
 
-    // brackets? address?
+    // brackets? register indirect, or address with an offset
     if (line.second[col] == '(') {
-      start = ++col;
+      // offset must be an integer
+      if (value.is_decimal) {
+        auto msg = std::make_unique<message::Message>(message::Error, loc);
+        msg->get() << "decimal number cannot be followed by '(' (got " << *(double *) &value.value << ")";
+        msgs.add(std::move(msg));
+        return;
+      }
 
-      // if constant was decimal, this is bad
-      if (found_number && number_decimal) {
+      if (!value.label.empty()) {
         auto msg = std::make_unique<message::Message>(message::Error, loc);
-        msg->get() << "decimal number cannot be followed by '(' (got " << *(double *) &value << ")";
+        msg->get() << "label " << value.label << " cannot be followed by '('";
         msgs.add(std::move(msg));
         return;
       }
 
+      start = ++col;
+
       // register?
       if (line.second[col] == '$') {
         col++;
@@ -687,65 +818,22 @@ namespace assembler::parser {
         col++;
 
         // update argument
-        argument.set_reg_indirect(reg.value(), (int32_t) value);
-        return;
-      }
-
-      // parse as number
-      uint64_t addr;
-      if (parse_number(line.second, col, addr, number_decimal)) {
-        // cannot have a number in this case
-        if (found_number) {
-          auto msg = std::make_unique<message::Message>(message::Error, loc);
-          msg->get() << "expected '$' for register-indirect or label, found '" << line.second[col] << "' after '('";
-          msgs.add(std::move(msg));
-          return;
-        }
-
-        // disallow decimals
-        if (number_decimal) {
-          auto msg = std::make_unique<message::Message>(message::Error, loc.copy().column(start));
-          msg->get() << "memory address cannot be a decimal!";
-          msgs.add(std::move(msg));
-          return;
-        }
-
-        // ending bracket?
-        if (line.second[col] != ')') {
-          auto msg = std::make_unique<message::Message>(message::Error, loc);
-          msg->get() << "expected ')', got ";
-          emit_ch(msg->get(), line.second, col);
-          msgs.add(std::move(msg));
-
-          msg = std::make_unique<message::Message>(message::Note, loc.copy().column(start - 1));
-          msg->get() << "group opened here";
-          msgs.add(std::move(msg));
-          return;
-        }
-
-        col++;
-
-        // update argument
-        argument.update(instruction::ArgumentType::Address, addr);
+        argument.set_reg_indirect(reg.value(), (int32_t) value.value);
         return;
       }
 
-      // extract until ')'
-      start = col;
-      skip_label(line.second, col);
+      // parse address
+      expression::Value address;
+      if (!expression::parse(line.second, col, loc, msgs, address)) return;
 
-      if (start == col) {
-        auto msg = std::make_unique<message::Message>(message::Error, loc);
-        msg->get() << "expected address or label, got '";
-        emit_ch(msg->get(), line.second, col);
-        msg->get() << "'";
+      // disallow decimals
+      if (address.is_decimal) {
+        auto msg = std::make_unique<message::Message>(message::Error, loc.copy().column(start));
+        msg->get() << "memory address cannot be a decimal!";
         msgs.add(std::move(msg));
         return;
       }
 
-      const std::string label = line.second.substr(start, col - start);
-      argument.set_label(label, value, true);
-
       // ending bracket?
       if (line.second[col] != ')') {
         auto msg = std::make_unique<message::Message>(message::Error, loc);
@@ -760,60 +848,37 @@ namespace assembler::parser {
       }
 
       col++;
-      return;
-    }
-
-    // nothing else to parse ...
-    // if found number, <imm>, else throw error
-    if (found_number) {
-      argument.update(number_decimal
-                      ? instruction::ArgumentType::DecimalImmediate
-                      : instruction::ArgumentType::Immediate, value);
-      return;
-    }
-
-    auto msg = std::make_unique<message::Message>(message::Error, loc);
-    msg->get() << "unexpected character '" << line.second[col] << "'";
-    msgs.add(std::move(msg));
-  }
 
-  void parse_character_literal(const Data &data, Location &loc, int line_idx, message::List &msgs, uint64_t &value) {
-    auto &line = data.lines[line_idx];
-    int &col = loc.columnref();
-
-    // Escape character
-    if (line.second[col] == '\\') {
-      if (!decode_escape_seq(line.second, ++col, value)) {
-        auto msg = std::make_unique<message::Message>(message::Error, loc);
-        msg->get() << "invalid escape sequence";
-        msgs.add(std::move(msg));
-        return;
+      // update argument
+      if (address.label.empty()) {
+        argument.update(instruction::ArgumentType::Address, address.value + value.value);
+      } else {
+        argument.set_label(data.intern(address.label), (int) (address.value + value.value), true);
       }
-    } else {
-      value = (uint8_t) line.second[col++];
+
+      return;
     }
 
-    // Check for ending apostrophe
-    if (line.second[col] != '\'') {
-      auto msg = std::make_unique<message::Message>(message::Error, loc);
-      msg->get() << "expected apostrophe to terminate character literal";
-      msgs.add(std::move(msg));
+    if (!value.label.empty()) {
+      argument.set_label(data.intern(value.label), (int) value.value);
       return;
     }
 
-    col++;
+    argument.update(value.is_decimal
+                    ? instruction::ArgumentType::DecimalImmediate
+                    : instruction::ArgumentType::Immediate, value.value);
   }
 
   void reconstruct_assembly(const Data &data, std::ostream &os) {
     for (auto &chunk: data.buffer) {
-      chunk->reconstruct(os);
+      data.buffer.reconstruct(chunk, os);
 
       // include debug info in comment?
       if (data.cli_args.debug) {
         os << "\t; ";
         //if (!chunk->is_data()) os << "0x" << std::hex << chunk->get_instruction()->compile() << std::dec << " ";
-        chunk->location().print(os, true);
-        os << "+" << chunk->offset;
+        data.location(chunk).print(os, true);
+        os << "+" << chunk.offset;
       }
 
       os << std::endl;
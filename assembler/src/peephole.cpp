@@ -0,0 +1,268 @@
+#include "peephole.hpp"
+#include "instructions/signature.hpp"
+
+#include <unordered_set>
+
+#include "constants.hpp"
+
+namespace assembler::peephole {
+  using namespace constants;
+  using instruction::Argument;
+  using instruction::ArgumentType;
+  using instruction::Instruction;
+
+  /** An instruction and the instruction which directly follows it, if any. */
+  struct Window {
+    Instruction *first;
+    Instruction *second; // nullptr if the next chunk is not an instruction
+    uint32_t next_offset; // offset of the chunk following `first`
+    bool second_is_target; // is a label declared at `second`?
+    uint8_t first_labels, second_labels; // mask of arguments which referenced a label
+    const std::map<std::string, Label> *labels;
+  };
+
+  /** Result of applying a pattern to a window. */
+  enum class Action {
+    None, // pattern does not match
+    RemoveFirst,
+    RemoveSecond,
+    RewriteSecond, // `second` has been rewritten in place
+  };
+
+  struct Pattern {
+    const char *description;
+    Action (*apply)(const Window &window);
+  };
+
+  /** Is the argument a register other than $pc or $flag, whose values depend on more than the register's contents? */
+  static bool is_general_register(const Argument &arg) {
+    return arg.get_type() == ArgumentType::Register && arg.get_data() != registers::pc &&
+           arg.get_data() != registers::flag;
+  }
+
+  /** Does the instruction read the flag register, by its test or an argument? */
+  static bool reads_flags(const Instruction &instruction) {
+    if (instruction.is_conditional()) return true;
+
+    for (const auto &arg: instruction.args) {
+      if (arg.get_type() == ArgumentType::Register && arg.get_data() == registers::flag) return true;
+      if (arg.get_type() == ArgumentType::RegisterIndirect && arg.get_reg_indirect()->reg == registers::flag) return true;
+    }
+
+    return false;
+  }
+
+  /** Are the flags set by `first` dead, i.e., does `second` always overwrite the zero flag before reading them? */
+  static bool flags_dead(const Window &window) {
+    if (window.second == nullptr || reads_flags(*window.second)) return false;
+
+    switch (window.second->signature->opcode) {
+      case inst::_load:
+      case inst::_load_upper:
+      case inst::_store:
+      case inst::_convert:
+      case inst::_not:
+      case inst::_and:
+      case inst::_or:
+      case inst::_xor:
+      case inst::_shr:
+      case inst::_shl:
+      case inst::_zext:
+      case inst::_sext:
+      case inst::_add:
+      case inst::_sub:
+      case inst::_mul:
+      case inst::_div:
+      case inst::_mod:
+        return true;
+      default:
+        return false;
+    }
+  }
+
+  /** Do the two address arguments refer to the same memory? */
+  static bool same_address(const Argument &a, bool a_label, const Argument &b, bool b_label) {
+    if (a.get_type() != b.get_type() || a_label != b_label) return false;
+
+    // undeclared labels all resolve to zero, so compare by name
+    if (a_label) {
+      return a.get_label()->label == b.get_label()->label && a.get_label()->offset == b.get_label()->offset;
+    }
+
+    switch (a.get_type()) {
+      case ArgumentType::Address:
+        return a.get_data() == b.get_data();
+      case ArgumentType::RegisterIndirect:
+        return a.get_reg_indirect()->reg == b.get_reg_indirect()->reg &&
+               a.get_reg_indirect()->offset == b.get_reg_indirect()->offset;
+      default:
+        return false;
+    }
+  }
+
+  // load $r, $r
+  static Action self_load(const Window &window) {
+    const auto &args = window.first->args;
+
+    if (window.first->signature->opcode != inst::_load || !is_general_register(args[0]) ||
+        args[1].get_type() != ArgumentType::Register || args[1].get_data() != args[0].get_data())
+      return Action::None;
+
+    return flags_dead(window) ? Action::RemoveFirst : Action::None;
+  }
+
+  // add $r, $r, 0 etc.
+  static Action identity_arithmetic(const Window &window) {
+    const Instruction &instruction = *window.first;
+
+    switch (instruction.signature->opcode) {
+      case inst::_add:
+      case inst::_sub: {
+        // 32-bit and floating-point arithmetic alter the register
+        const auto &datatypes = instruction.get_datatypes();
+        if (datatypes.size() != 1 || (datatypes.front() != inst::datatype::u64 && datatypes.front() != inst::datatype::s64))
+          return Action::None;
+        break;
+      }
+      case inst::_or:
+      case inst::_xor:
+      case inst::_shl:
+      case inst::_shr:
+        break;
+      default:
+        return Action::None;
+    }
+
+    const auto &args = instruction.args;
+
+    if (args.size() != 3 || !is_general_register(args[0]) || args[1].get_type() != ArgumentType::Register ||
+        args[1].get_data() != args[0].get_data() || args[2].get_type() != ArgumentType::Immediate ||
+        args[2].get_data() != 0 || (window.first_labels & 0b100))
+      return Action::None;
+
+    return flags_dead(window) ? Action::RemoveFirst : Action::None;
+  }
+
+  // jmp <label>, where <label> is the next instruction
+  static Action jump_to_next(const Window &window) {
+    const auto &args = window.first->args;
+
+    if (window.first->signature->opcode != inst::_load || args[0].get_type() != ArgumentType::Register ||
+        args[0].get_data() != registers::pc || args[1].get_type() != ArgumentType::Immediate ||
+        !(window.first_labels & 0b10) || !window.labels->contains(*args[1].get_label()->label) ||
+        args[1].get_data() != window.next_offset)
+      return Action::None;
+
+    return flags_dead(window) ? Action::RemoveFirst : Action::None;
+  }
+
+  // store $r, <addr>; load $s, <addr>
+  static Action load_after_store(const Window &window) {
+    if (window.second == nullptr || window.second_is_target) return Action::None;
+
+    const Instruction &store = *window.first;
+    Instruction &load = *window.second;
+
+    // $pc and $flag change as the store executes, so may no longer hold the stored value
+    if (store.signature->opcode != inst::_store || load.signature->opcode != inst::_load || store.is_conditional() ||
+        load.is_conditional() || !is_general_register(store.args[0]) ||
+        !same_address(store.args[1], window.first_labels & 0b10, load.args[1], window.second_labels & 0b10))
+      return Action::None;
+
+    // the register still holds the stored value
+    if (load.args[0].get_data() == store.args[0].get_data()) return Action::RemoveSecond;
+
+    load.args[1] = Argument(ArgumentType::Register, store.args[0].get_data());
+    return Action::RewriteSecond;
+  }
+
+  const Pattern patterns[] = {
+      {"load of a register into itself", self_load},
+      {"arithmetic identity", identity_arithmetic},
+      {"jump to the next instruction", jump_to_next},
+      {"load of a just-stored address", load_after_store},
+  };
+
+  uint32_t optimise(Data &data) {
+    if (!data.is_movable()) {
+      if (data.cli_args.debug)
+        std::cout << "peephole: skipped, as .org moves backwards" << std::endl;
+
+      return 0;
+    }
+
+    uint32_t removed_count = 0;
+    std::vector<bool> touched(data.buffer.instruction_count()); // removed or rewritten instructions
+
+    for (bool changed = true; changed;) {
+      changed = false;
+
+      // arguments of each instruction which referenced a label
+      std::vector<uint8_t> label_args(data.buffer.instruction_count());
+
+      for (const Reference &reference: data.references) {
+        if (reference.instruction >= 0) label_args[reference.instruction] |= 1 << reference.arg;
+      }
+
+      std::unordered_set<uint64_t> targets;
+
+      for (const auto &[name, label]: data.labels) {
+        targets.insert(label.addr);
+      }
+
+      std::vector<bool> removed(data.buffer.size());
+
+      for (size_t i = 0; i < data.buffer.size(); i++) {
+        const Chunk &chunk = data.buffer[i];
+        if (chunk.type != ChunkType::Instruction) continue;
+
+        Window window{&data.buffer.instruction(chunk.index), nullptr, chunk.offset + chunk.size, false,
+                      label_args[chunk.index], 0, &data.labels};
+
+        if (i + 1 < data.buffer.size()) {
+          const Chunk &next = data.buffer[i + 1];
+
+          if (next.type == ChunkType::Instruction && next.offset == window.next_offset) {
+            window.second = &data.buffer.instruction(next.index);
+            window.second_is_target = targets.contains(next.offset);
+            window.second_labels = label_args[next.index];
+          }
+        }
+
+        for (const Pattern &pattern: patterns) {
+          Action action = pattern.apply(window);
+          if (action == Action::None) continue;
+
+          if (data.cli_args.debug)
+            std::cout << data.location(chunk) << " peephole: " << pattern.description << std::endl;
+
+          changed = true;
+
+          if (action == Action::RemoveFirst) {
+            removed[i] = true;
+            touched[chunk.index] = true;
+            removed_count++;
+          } else {
+            // the second instruction is not matched again this pass
+            const Chunk &next = data.buffer[++i];
+            touched[next.index] = true;
+
+            if (action == Action::RemoveSecond) {
+              removed[i] = true;
+              removed_count++;
+            }
+          }
+
+          break;
+        }
+      }
+
+      if (changed) data.remove_chunks(removed, touched);
+    }
+
+    if (data.cli_args.debug)
+      std::cout << "peephole: removed " << removed_count << " instruction(s)" << std::endl;
+
+    return removed_count;
+  }
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cstdint>
+
+#include "assembler_data.hpp"
+
+/**
+ * Peephole optimiser over parsed instructions. Adjacent instructions are matched against a table of patterns, which
+ * may rewrite or remove them. Following chunks, labels and label references are then moved down to close the gaps,
+ * except for those fixed by a .org directive.
+ */
+namespace assembler::peephole {
+  /** Optimise the instructions in `data` until no pattern matches, return the number of instructions removed. */
+  uint32_t optimise(Data &data);
+}
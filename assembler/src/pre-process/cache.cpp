@@ -0,0 +1,248 @@
+#include "cache.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <unistd.h>
+
+#include "pre-processor.hpp"
+#include "serialise.hpp"
+
+namespace assembler::pre_processor::cache {
+  using namespace serialise;
+
+  /** Fold the given bytes into an FNV-1a hash. */
+  static uint64_t fnv1a(uint64_t hash, const void *data, size_t size) {
+    for (size_t i = 0; i < size; i++) {
+      hash = (hash ^ ((const uint8_t *) data)[i]) * 0x100000001b3;
+    }
+
+    return hash;
+  }
+
+  static constexpr uint64_t fnv1a_offset = 0xcbf29ce484222325;
+
+  static uint64_t fnv1a(uint64_t hash, const std::string &str) {
+    // include size, so adjacent strings cannot run together
+    uint64_t size = str.size();
+    return fnv1a(fnv1a(hash, &size, sizeof(size)), str.data(), str.size());
+  }
+
+  static std::filesystem::path entry_path(const std::filesystem::path &directory, uint64_t key) {
+    std::stringstream name;
+    name << std::hex << key << ".pp";
+    return directory / name.str();
+  }
+
+  static void write_location(std::ostream &os, const Location &loc) {
+    write_string(os, loc.path().string());
+    write_value<int32_t>(os, loc.line());
+    write_value<int32_t>(os, loc.column());
+  }
+
+  static bool read_location(std::istream &is, Location &loc) {
+    std::string path;
+    int32_t line, column;
+    if (!read_string(is, path) || !read_value(is, line) || !read_value(is, column)) return false;
+
+    loc = Location(path, line, column);
+    return true;
+  }
+
+  uint64_t hash(const std::vector<Line> &lines) {
+    uint64_t hash = fnv1a_offset;
+
+    for (const auto &line: lines) {
+      int32_t line_no = line.first.line();
+      hash = fnv1a(fnv1a(hash, &line_no, sizeof(line_no)), line.second);
+    }
+
+    return hash;
+  }
+
+  uint64_t key(const Data &data, const std::filesystem::path &canonical_path, uint64_t content_hash) {
+    uint64_t hash = fnv1a(fnv1a_offset, &version, sizeof(version));
+
+    // identify the assembler by its executable, so rebuilding it invalidates the cache
+    std::error_code error;
+    auto modified = std::filesystem::last_write_time(data.executable, error).time_since_epoch().count();
+    auto size = std::filesystem::file_size(data.executable, error);
+    hash = fnv1a(hash, &modified, sizeof(modified));
+    hash = fnv1a(hash, &size, sizeof(size));
+
+    hash = fnv1a(hash, data.cli_args.lib_path.string());
+    hash = fnv1a(hash, canonical_path.string());
+    return fnv1a(hash, &content_hash, sizeof(content_hash));
+  }
+
+  bool load(const std::filesystem::path &directory, uint64_t key, Data &data) {
+    std::ifstream file(entry_path(directory, key), std::ios::in | std::ios::binary);
+    if (!file.is_open()) return false;
+
+    char file_magic[sizeof(magic)];
+    uint32_t file_version;
+    uint64_t file_key;
+
+    if (!file.read(file_magic, sizeof(file_magic)) || std::memcmp(file_magic, magic, sizeof(magic)) != 0
+        || !read_value(file, file_version) || file_version != version || !read_value(file, file_key)
+        || file_key != key) {
+      return false;
+    }
+
+    // check that dependencies are unchanged, and are not already included
+    uint32_t count;
+    if (!read_value(file, count)) return false;
+
+    std::vector<std::pair<std::filesystem::path, uint64_t>> dependencies(count);
+
+    for (auto &[path, hash]: dependencies) {
+      std::string path_string;
+      if (!read_string(file, path_string) || !read_value(file, hash)) return false;
+      path = path_string;
+
+      if (data.included_files.contains(path)) return false;
+
+      Data dependency(data.cli_args);
+      message::List messages;
+      read_source_file(path, dependency, messages);
+
+      if (messages.has_message_of(message::Error) || cache::hash(dependency.lines) != hash) return false;
+    }
+
+    // read pre-processed lines
+    std::vector<Line> lines;
+    if (!read_value(file, count)) return false;
+
+    for (uint32_t i = 0; i < count; i++) {
+      Location loc("");
+      std::string str;
+      if (!read_location(file, loc) || !read_string(file, str)) return false;
+
+      lines.emplace_back(std::move(loc), std::move(str));
+    }
+
+    std::vector<std::pair<Location, Location>> origins;
+    if (!read_value(file, count)) return false;
+
+    for (uint32_t i = 0; i < count; i++) {
+      Location loc(""), origin("");
+      if (!read_location(file, loc) || !read_location(file, origin)) return false;
+
+      origins.emplace_back(std::move(loc), std::move(origin));
+    }
+
+    // read definitions
+    std::unordered_map<std::string, Constant> constants;
+    if (!read_value(file, count)) return false;
+
+    for (uint32_t i = 0; i < count; i++) {
+      std::string name;
+      Constant constant{Location("")};
+      if (!read_string(file, name) || !read_location(file, constant.loc) || !read_string(file, constant.value)) {
+        return false;
+      }
+
+      constants.insert({std::move(name), std::move(constant)});
+    }
+
+    std::map<std::string, Macro> macros;
+    if (!read_value(file, count)) return false;
+
+    for (uint32_t i = 0; i < count; i++) {
+      std::string name;
+      Macro macro(Location(""), {});
+      uint32_t size;
+
+      if (!read_string(file, name) || !read_location(file, macro.loc) || !read_value(file, size)) return false;
+      macro.params.resize(size);
+      for (auto &param: macro.params) {
+        if (!read_string(file, param)) return false;
+      }
+
+      if (!read_value(file, size)) return false;
+      macro.lines.resize(size);
+      for (auto &line: macro.lines) {
+        if (!read_string(file, line)) return false;
+      }
+
+      macro.compile();
+      macros.insert({std::move(name), std::move(macro)});
+    }
+
+    data.dependencies = std::move(dependencies);
+    data.lines = std::move(lines);
+    data.line_origins = std::move(origins);
+    data.constants = std::move(constants);
+    data.macros = std::move(macros);
+    return true;
+  }
+
+  void store(const std::filesystem::path &directory, uint64_t key, const Data &data) {
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    if (error) return;
+
+    // write to a temporary file first, so concurrent readers never see a partial entry
+    auto path = entry_path(directory, key);
+    auto temp_path = path;
+    // the name is unique to this process and thread, as thread ids may repeat across processes
+    temp_path += "." + std::to_string(getpid()) + "." +
+                 std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id())) + ".tmp";
+
+    {
+      std::ofstream file(temp_path, std::ios::out | std::ios::binary);
+      if (!file.is_open()) return;
+
+      file.write(magic, sizeof(magic));
+      write_value(file, version);
+      write_value(file, key);
+
+      write_value<uint32_t>(file, data.dependencies.size());
+      for (const auto &[dependency, hash]: data.dependencies) {
+        write_string(file, dependency.string());
+        write_value(file, hash);
+      }
+
+      write_value<uint32_t>(file, data.lines.size());
+      for (const auto &line: data.lines) {
+        write_location(file, line.first);
+        write_string(file, line.second);
+      }
+
+      write_value<uint32_t>(file, data.line_origins.size());
+      for (const auto &[loc, origin]: data.line_origins) {
+        write_location(file, loc);
+        write_location(file, origin);
+      }
+
+      write_value<uint32_t>(file, data.constants.size());
+      for (const auto &[name, constant]: data.constants) {
+        write_string(file, name);
+        write_location(file, constant.loc);
+        write_string(file, constant.value);
+      }
+
+      write_value<uint32_t>(file, data.macros.size());
+      for (const auto &[name, macro]: data.macros) {
+        write_string(file, name);
+        write_location(file, macro.loc);
+
+        write_value<uint32_t>(file, macro.params.size());
+        for (const auto &param: macro.params) write_string(file, param);
+
+        write_value<uint32_t>(file, macro.lines.size());
+        for (const auto &line: macro.lines) write_string(file, line);
+      }
+
+      if (!file) {
+        file.close();
+        std::filesystem::remove(temp_path, error);
+        return;
+      }
+    }
+
+    std::filesystem::rename(temp_path, path, error);
+    if (error) std::filesystem::remove(temp_path, error);
+  }
+}
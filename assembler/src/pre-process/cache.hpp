@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+
+#include "data.hpp"
+
+/**
+ * On-disk cache of pre-processed %include-d files. An included file is pre-processed in isolation, so its result
+ * depends only on its contents, the contents of any file it includes, the library path and the assembler itself.
+ */
+namespace assembler::pre_processor::cache {
+  // first bytes of every cache entry, followed by its format version
+  constexpr char magic[4] = {'E', 'P', 'P', 'C'};
+  constexpr uint32_t version = 2;
+
+  /** Hash the given source lines, including their line numbers. */
+  uint64_t hash(const std::vector<Line> &lines);
+
+  /** Get key of the cache entry for the given file, whose lines have been read into `data`. */
+  uint64_t key(const Data &data, const std::filesystem::path &canonical_path, uint64_t content_hash);
+
+  /**
+   * Replace the contents of `data` with a cached entry, return success. Entries whose dependencies have changed, or
+   * which would include a file in `data.included_files`, are ignored.
+   */
+  bool load(const std::filesystem::path &directory, uint64_t key, Data &data);
+
+  /** Store the pre-processed contents of `data`. Failure is silently ignored. */
+  void store(const std::filesystem::path &directory, uint64_t key, const Data &data);
+}
@@ -13,15 +13,16 @@ namespace assembler::pre_processor {
     return os;
   }
 
-  void Data::merge(Data &other, int line_index) {
-    // Merge lines
-    auto lines_ptr = line_index < 0 ? lines.end() - 1 + line_index : lines.begin() + line_index;
-    lines.insert(lines_ptr, other.lines.begin(), other.lines.end());
-
+  void Data::merge(Data &other) {
     // Merge constants
     constants.insert(other.constants.begin(), other.constants.end());
+    if (!other.constants.empty()) constants_version++;
 
-    // Merge macros
-    macros.insert(other.macros.begin(), other.macros.end());
+    // Merge macros, whose bodies have only seen the other's constants
+    for (const auto &[name, macro]: other.macros) {
+      if (auto [it, inserted] = macros.insert({name, macro}); inserted) {
+        it->second.constants_version = Macro::stale;
+      }
+    }
   }
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <map>
+#include <unordered_map>
 
 #include "constant.hpp"
 #include "macro.hpp"
@@ -15,9 +16,12 @@ namespace assembler::pre_processor {
     std::filesystem::path executable; // Path to executable
     std::filesystem::path file_path; // Name of source file (may be different to base.input_filename if parsing an include)
     std::vector<Line> lines; // List of source file lines
-    std::map<std::string, Constant> constants; // Map of constant values (%define)
+    std::unordered_map<std::string, Constant> constants; // Map of constant values (%define)
     std::map<std::string, Macro> macros; // Map of macros
     std::map<std::filesystem::path, Location> included_files; // Maps included files to where they were included
+    std::vector<std::pair<std::filesystem::path, uint64_t>> dependencies; // Files %include-d, with a hash of their contents
+    std::vector<std::pair<Location, Location>> line_origins; // Maps a line's location to the origin given by its ";@" comment
+    uint32_t constants_version = 0; // Incremented whenever constants change, see Macro::constants_version
 
     explicit Data(CliArguments &args) : cli_args(args) {}
 
@@ -32,7 +36,7 @@ namespace assembler::pre_processor {
     /** Writes `lines` to buffer. */
     std::ostream &write_lines(std::ostream &os) const;
 
-    /** Merge given data with this. Insert lines starting at `index`. */
-    void merge(Data &other, int line_index = -1);
+    /** Merge constants and macros of the given data with this. */
+    void merge(Data &other);
   };
 }
@@ -1,15 +1,30 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
 #include <utility>
 #include <vector>
 
 namespace assembler::pre_processor {
+  /** Line of a macro's body, split into literal text and the parameters substituted between it. */
+  struct MacroLine {
+    std::vector<std::string> literals; // Text before each slot, followed by the text after the last
+    std::vector<int> slots; // Index of the parameter substituted into each slot
+  };
+
   struct Macro {
+    static constexpr int max_depth = 256; // Maximum nesting of expansions, so a recursive macro is reported
+    static constexpr uint32_t stale = UINT32_MAX; // constants_version of a macro whose constants must be re-substituted
+
     Location loc;
     std::vector<std::string> params;
     std::vector<std::string> lines; // Lines in macro's body
+    std::vector<MacroLine> body; // Lines compiled by compile(), used for expansion
+    uint32_t constants_version = 0; // Data::constants_version when the body's constants were substituted
 
     Macro(Location loc, std::vector<std::string> params) : loc(std::move(loc)), params(std::move(params)) {}
+
+    /** Compile `lines` into `body`, once the definition is complete. */
+    void compile();
   };
 }
@@ -1,24 +1,153 @@
 #include "pre-processor.hpp"
 #include "util.hpp"
 
+#include <algorithm>
+#include <charconv>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include <fstream>
 #include <iostream>
+#include <sstream>
+#include <unordered_map>
 #include "data.hpp"
+#include "cache.hpp"
 
 namespace assembler {
+  int substitute_symbols(std::string &line, const std::function<const std::string *(const std::string &)> &lookup,
+                         const std::function<void(int, const std::string &, const std::string &)> &on_substitute) {
+    std::string result;
+    int substitutions = 0;
+    size_t copied = 0; // index into `line` up to which has been copied to `result`
+    char quote = 0; // quote character of the literal we are in, if any
+
+    for (size_t i = 0; i < line.size();) {
+      char ch = line[i];
+
+      // skip over string and character literals
+      if (quote) {
+        if (ch == '\\') i++;
+        else if (ch == quote) quote = 0;
+        i++;
+        continue;
+      }
+
+      if (ch == '"' || ch == '\'') {
+        quote = ch;
+        i++;
+        continue;
+      }
+
+      if (!std::isalnum((unsigned char) ch) && ch != '_') {
+        i++;
+        continue;
+      }
+
+      // extract the whole token -- numbers and registers are never symbols
+      size_t start = i;
+      while (i < line.size() && (std::isalnum((unsigned char) line[i]) || line[i] == '_')) i++;
+      if (std::isdigit((unsigned char) ch) || (start > 0 && line[start - 1] == '$')) continue;
+
+      std::string symbol = line.substr(start, i - start);
+      const std::string *value = lookup(symbol);
+      if (value == nullptr) continue;
+
+      result.append(line, copied, start - copied);
+      if (on_substitute) on_substitute((int) result.size(), symbol, *value);
+      result += *value;
+      copied = i;
+      substitutions++;
+    }
+
+    if (substitutions > 0) {
+      result.append(line, copied);
+      line = std::move(result);
+    }
+
+    return substitutions;
+  }
+
+  /** Append each non-empty line of `source` to `data.lines`. Every line's location shares the file's path. */
+  static void read_lines(std::string_view source, const std::filesystem::path &filepath, pre_processor::Data &data) {
+    data.file_path = filepath;
+    data.lines.reserve(data.lines.size() + std::count(source.begin(), source.end(), '\n') + 1);
+    const Location file(filepath);
+    int line = 1;
+
+    for (size_t start = 0; start < source.size(); line++) {
+      size_t end = std::min(source.find('\n', start), source.size());
+
+      if (end > start)
+        data.lines.emplace_back(file.copy().line(line), std::string(source.substr(start, end - start)));
+
+      start = end + 1;
+    }
+  }
+
+  /** Read the lines of a regular file by mapping it into memory, return false if it cannot be mapped. */
+  static bool map_source_file(const std::filesystem::path &filepath, pre_processor::Data &data) {
+    int fd = ::open(filepath.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat info{};
+    void *mapping = MAP_FAILED;
+    bool mapped = fstat(fd, &info) == 0 && S_ISREG(info.st_mode);
+
+    if (mapped && info.st_size > 0) {
+      mapping = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      mapped = mapping != MAP_FAILED;
+    }
+
+    close(fd);
+    if (!mapped) return false;
+
+    if (mapping == MAP_FAILED) {
+      // empty file
+      data.file_path = filepath;
+    } else {
+      read_lines({(const char *) mapping, (size_t) info.st_size}, filepath, data);
+      munmap(mapping, info.st_size);
+    }
+
+    return true;
+  }
+
+  void read_source(std::istream &stream, const std::filesystem::path &filepath, pre_processor::Data &data) {
+    std::ostringstream source;
+    source << stream.rdbuf();
+    read_lines(source.view(), filepath, data);
+  }
+
   void read_source_file(pre_processor::Data &data, message::List &msgs) {
     auto &handle = *data.cli_args.source;
-    data.file_path = handle.path;
-    std::string str;
 
-    for (int i = 0; std::getline(handle.stream, str); i++) {
-      if (!str.empty())
-        data.lines.emplace_back(Location(handle.path, i + 1), str);
+    // fall back to the open stream if it is not a regular file, e.g., a pipe
+    if (!map_source_file(handle.path, data)) {
+      read_source(handle.stream, handle.path, data);
     }
   }
 
   void read_source_file(const std::filesystem::path &filepath, pre_processor::Data &data, message::List &msgs) {
-    data.file_path = filepath;
+    // read via the resolver, if one is provided, rather than from disk
+    if (auto &resolver = data.cli_args.include_resolver) {
+      std::string contents;
+
+      if (!resolver(filepath, contents)) {
+        auto msg = std::make_unique<message::Message>(message::Error, Location(filepath));
+        msg->get() << "cannot read file " << filepath;
+        msgs.add(std::move(msg));
+        return;
+      }
+
+      read_lines(contents, filepath, data);
+      return;
+    }
+
+    if (map_source_file(filepath, data)) {
+      return;
+    }
+
     std::ifstream file(filepath);
 
     if (!file.is_open()) {
@@ -34,13 +163,7 @@ namespace assembler {
       return;
     }
 
-    std::string str;
-
-    for (int i = 0; std::getline(file, str); i++) {
-      if (!str.empty())
-        data.lines.emplace_back(Location(filepath, i + 1), str);
-    }
-
+    read_source(file, filepath, data);
     file.close();
   }
 
@@ -48,186 +171,297 @@ namespace assembler {
     // Keep track of the current macro (if nullptr we are not in a macro definition)
     std::pair<std::string, pre_processor::Macro> *current_macro = nullptr;
 
-    for (int lines_idx = 0; lines_idx < data.lines.size(); lines_idx++) {
-      auto &line = data.lines[lines_idx];
+    // Stream the source lines through the pre-processor, which appends its output to `data.lines`
+    std::vector<pre_processor::Line> source = std::move(data.lines);
+    data.lines.clear();
+    data.lines.reserve(source.size());
 
-      // Trim leading and trailing whitespace
-      trim(line.second);
+    for (auto &line: source) {
+      if (!pre_process_line(data, std::move(line), current_macro, msgs)) {
+        break;
+      }
+    }
 
-      // is the line empty?
-      if (line.second.empty()) {
-        data.lines.erase(data.lines.begin() + lines_idx);
-        lines_idx--;
-        continue;
+    // A definition without %end runs to the end of the source
+    if (current_macro) {
+      current_macro->second.compile();
+    }
+  }
+
+  void pre_processor::Macro::compile() {
+    // substitute each parameter with the empty string, noting where it was, to find the slots
+    static const std::string empty;
+    body.clear();
+    body.reserve(lines.size());
+
+    for (const auto &line: lines) {
+      MacroLine &compiled = body.emplace_back();
+      std::string text = line;
+      std::vector<int> columns;
+
+      substitute_symbols(text, [this](const std::string &symbol) -> const std::string * {
+        return std::ranges::find(params, symbol) == params.end() ? nullptr : &empty;
+      }, [this, &compiled, &columns](int col, const std::string &param, const std::string &) {
+        columns.push_back(col);
+        compiled.slots.push_back((int) (std::ranges::find(params, param) - params.begin()));
+      });
+
+      int start = 0;
+
+      for (int col: columns) {
+        compiled.literals.push_back(text.substr(start, col - start));
+        start = col;
       }
 
-      // Remove comments
-      bool in_string = false, was_comment = false;
+      compiled.literals.push_back(text.substr(start));
+    }
+  }
+
+  /** Replace constants in the line with their value. */
+  static void substitute_constants(pre_processor::Data &data, pre_processor::Line &line) {
+    if (data.constants.empty()) return;
+
+    std::function<void(int, const std::string &, const std::string &)> on_substitute;
+
+    if (data.cli_args.debug)
+      on_substitute = [&line](int col, const std::string &symbol, const std::string &value) {
+        std::cout << line.first << " CONSTANT: substitute symbol " << symbol << std::endl;
+      };
 
-      for (int i = 0; i < line.second.size(); i++) {
-        if (line.second[i] == '"') {
-          in_string = !in_string;
-        } else if (!in_string && line.second[i] == ';') {
-          line.second = line.second.substr(0, i);
-          was_comment = true;
+    substitute_symbols(line.second, [&data](const std::string &symbol) -> const std::string * {
+      auto constant = data.constants.find(symbol);
+      return constant == data.constants.end() ? nullptr : &constant->second.value;
+    }, on_substitute);
+  }
+
+  /**
+   * Expand a call to `macro`, whose arguments follow index `i` in `line`, appending the expansion to `data.lines`.
+   * `depth` is the number of expansions this call is nested in. Return false if pre-processing should stop.
+   */
+  static bool expand_macro(pre_processor::Data &data, const pre_processor::Line &line, const std::string &mnemonic,
+                           int i, const pre_processor::Macro &macro, int depth, message::List &msgs) {
+    if (data.cli_args.debug)
+      std::cout << line.first << " CALL TO MACRO " << mnemonic << std::endl << "\tArgs:";
+
+    // Collect arguments
+    std::vector<std::string> arguments;
+    int j;
+
+    while (true) {
+      skip_whitespace(line.second, i);
+
+      // Extract argument data up to a break outside brackets, e.g., `8($fp)` or `(1 + 2)*4`
+      j = i;
+
+      for (int depth = 0; i < line.second.size(); i++) {
+        char ch = line.second[i];
+
+        if (ch == '(' || ch == '[') {
+          depth++;
+        } else if (ch == ')' || ch == ']') {
+          // an unmatched closing bracket ends the argument
+          if (depth-- == 0) {
+            i++;
+            break;
+          }
+        } else if (depth == 0 && (ch == ' ' || ch == ',')) {
           break;
         }
       }
 
-      // Remove any whitespace which may be left over after comment was removed
-      if (was_comment) {
-        rtrim(line.second);
+      // Check if argument is the empty string
+      if (i == j)
+        break;
 
-        if (line.second.empty()) {
-          data.lines.erase(data.lines.begin() + lines_idx);
-          lines_idx--;
-          continue;
-        }
-      }
+      // Add to argument list
+      std::string argument = line.second.substr(j, i - j);
 
-      // Section header?
-      if (starts_with(line.second, ".section")) {
-        continue;
-      }
+      if (data.cli_args.debug)
+        std::cout << argument << " ";
 
-      // Have we found a directive?
-      if (line.second[0] == '%') {
-        process_directive(data, 1, lines_idx, line, current_macro, msgs);
+      arguments.push_back(std::move(argument));
+      skip_whitespace(line.second, i);
 
-        if (msgs.has_message_of(message::Error)) {
-          return;
-        }
+      if (i < line.second.size() && line.second[i] == ',')
+        i++;
 
-        // Directive has been handled - now remove current line
-        data.lines.erase(data.lines.begin() + lines_idx);
-        lines_idx--;
+      if (i == line.second.size())
+        break;
+    }
 
-        continue;
-      }
+    if (data.cli_args.debug) {
+      if (arguments.empty()) std::cout << "(none)";
+      std::cout << std::endl;
+    }
 
-      // Replace constants in line with their value
-      for (const auto &pair: data.constants) {
-        size_t index = 0;
+    // Check that argument sizes match
+    if (macro.params.size() != arguments.size()) {
+      auto msg = std::make_unique<message::Message>(message::Error, Location(line.first).column(mnemonic.size()));
+      msg->get() << "macro " << mnemonic + " expects " << macro.params.size()
+                 << " argument(s), received " << arguments.size();
+      msgs.add(std::move(msg));
 
-        while ((index = line.second.find(pair.first, index)) != std::string::npos) {
-          if (data.cli_args.debug)
-            std::cout << line.first << " CONSTANT: substitute symbol " << pair.first << std::endl;
+      msg = std::make_unique<message::Message>(message::Note, macro.loc);
+      msg->get() << "macro \"" << mnemonic << "\" defined here";
+      msgs.add(std::move(msg));
+      return false;
+    }
 
-          line.second.replace(index, pair.first.size(), pair.second.value);
-          index += pair.second.value.size();
-        }
-      }
+    if (depth == pre_processor::Macro::max_depth) {
+      auto msg = std::make_unique<message::Message>(message::Error, line.first);
+      msg->get() << "macro " << mnemonic << " nested more than " << pre_processor::Macro::max_depth
+                 << " expansions deep";
+      msgs.add(std::move(msg));
+
+      msg = std::make_unique<message::Message>(message::Note, macro.loc);
+      msg->get() << "macro \"" << mnemonic << "\" defined here";
+      msgs.add(std::move(msg));
+      return false;
+    }
 
-      // If in macro, add to body
-      if (current_macro) {
-        current_macro->second.lines.push_back(line.second);
+    // The body's constants were substituted when it was defined, unless they have changed since
+    bool substitute = macro.constants_version != data.constants_version;
 
-        // Remove line from normal program
-        data.lines.erase(data.lines.begin() + lines_idx);
-        lines_idx--;
+    // Fill the template's slots with the arguments
+    for (const auto &compiled: macro.body) {
+      pre_processor::Line expansion{line.first, compiled.literals.front()};
 
-        continue;
+      for (int slot = 0; slot < compiled.slots.size(); slot++) {
+        const std::string &argument = arguments[compiled.slots[slot]];
+
+        if (data.cli_args.debug)
+          std::cout << "\tCol " << expansion.second.size() << ": EXPANSION: substitute parameter "
+                    << macro.params[compiled.slots[slot]] << " with value \"" << argument << "\"\n";
+
+        expansion.second += argument;
+        expansion.second += compiled.literals[slot + 1];
       }
 
-      // Extract mnemonic
-      int i = 0;
-      skip_non_whitespace(line.second, i);
-      std::string mnemonic = line.second.substr(0, i);
+      if (substitute)
+        substitute_constants(data, expansion);
 
-      // Have we a macro?
-      auto macro_exists = data.macros.find(mnemonic);
+      // Expand calls to other macros, else output the line
+      int k = 0;
+      skip_non_whitespace(expansion.second, k);
+      std::string inner = expansion.second.substr(0, k);
 
-      if (macro_exists != data.macros.end()) {
-        if (data.cli_args.debug)
-          std::cout << line.first << " CALL TO MACRO " << mnemonic << std::endl << "\tArgs:";
+      if (auto inner_macro = data.macros.find(inner); inner_macro != data.macros.end()) {
+        if (!expand_macro(data, expansion, inner, k, inner_macro->second, depth + 1, msgs))
+          return false;
+      } else {
+        data.lines.push_back(std::move(expansion));
+      }
+    }
 
-        // Collect arguments
-        std::vector<std::string> arguments;
-        int j;
+    return true;
+  }
 
-        while (true) {
-          skip_whitespace(line.second, i);
+  /** Parse the origin given by a ";@<file>:<line>[:<column>]" comment, as emitted by the compiler. */
+  static std::optional<Location> parse_origin(const std::string &comment) {
+    // the path may contain colons, so read up to two numbers from the end
+    int numbers[2], count = 0;
+    size_t end = comment.size();
 
-          // Extract argument data
-          j = i;
-          skip_to_break(line.second, i);
+    while (count < 2) {
+      size_t colon = comment.rfind(':', end - 1);
+      if (colon == std::string::npos || colon == 0) break;
 
-          // Check if argument is the empty string
-          if (i == j)
-            break;
+      auto [ptr, error] = std::from_chars(comment.data() + colon + 1, comment.data() + end, numbers[count]);
+      if (error != std::errc() || ptr != comment.data() + end) break;
 
-          // Add to argument list
-          std::string argument = line.second.substr(j, i - j + 1);
-          arguments.push_back(argument);
+      count++;
+      end = colon;
+    }
 
-          if (data.cli_args.debug)
-            std::cout << argument << " ";
+    switch (count) {
+      case 1:
+        return Location(comment.substr(0, end), numbers[0]);
+      case 2:
+        return Location(comment.substr(0, end), numbers[1], numbers[0]);
+      default:
+        return std::nullopt;
+    }
+  }
 
-          if (line.second[i] == ',')
-            i++;
+  bool pre_process_line(pre_processor::Data &data, pre_processor::Line line,
+                        std::pair<std::string, pre_processor::Macro> *&current_macro, message::List &msgs) {
+    // Trim leading and trailing whitespace
+    trim(line.second);
 
-          if (i == line.second.size())
-            break;
-        }
+    // is the line empty?
+    if (line.second.empty()) {
+      return true;
+    }
 
-        if (data.cli_args.debug) {
-          if (arguments.empty()) std::cout << "(none)";
-          std::cout << std::endl;
-        }
+    // Remove comments
+    bool in_string = false, was_comment = false;
 
-        // Check that argument sizes match
-        if (macro_exists->second.params.size() != arguments.size()) {
-          auto msg = std::make_unique<message::Message>(message::Error, Location(line.first).column(mnemonic.size()));
-          msg->get() << "macro " << mnemonic + " expects " << macro_exists->second.params.size()
-                     << " argument(s), received " << arguments.size();
-          msgs.add(std::move(msg));
+    for (int i = 0; i < line.second.size(); i++) {
+      if (line.second[i] == '"') {
+        in_string = !in_string;
+      } else if (!in_string && line.second[i] == ';') {
+        // record origin of compiler output, which follows any other comment
+        if (size_t at = line.second.find(";@", i); at != std::string::npos) {
+          std::string comment = line.second.substr(at + 2);
+          trim(comment);
 
-          msg = std::make_unique<message::Message>(message::Note, macro_exists->second.loc);
-          msg->get() << "macro \"" << mnemonic << "\" defined here";
-          msgs.add(std::move(msg));
-          return;
+          if (auto origin = parse_origin(comment)) {
+            data.line_origins.emplace_back(line.first, std::move(*origin));
+          }
         }
 
-        // Remove this line from the program - it will be replaced soon
-        auto old_line = line;
-        data.lines.erase(data.lines.begin() + lines_idx);
+        line.second = line.second.substr(0, i);
+        was_comment = true;
+        break;
+      }
+    }
 
-        int insert_idx = lines_idx;
+    // Remove any whitespace which may be left over after comment was removed
+    if (was_comment) {
+      rtrim(line.second);
 
-        // Insert macro's lines
-        for (auto macro_line: macro_exists->second.lines) {
-          int arg_index = 0;
+      if (line.second.empty()) {
+        return true;
+      }
+    }
 
-          // Replace any parameters with its respective argument value
-          for (const auto &param: macro_exists->second.params) {
-            size_t index = 0;
-            std::string &arg = arguments[arg_index];
+    // Section header?
+    if (starts_with(line.second, ".section")) {
+      data.lines.push_back(std::move(line));
+      return true;
+    }
 
-            while ((index = macro_line.find(param, index)) != std::string::npos) {
-              if (data.cli_args.debug) {
-                std::cout << "\tCol " << index << ": EXPANSION: substitute parameter " << param
-                          << " with value \"" <<
-                          arg << "\"\n";
-              }
+    // Have we found a directive? It is handled here, so is not output
+    if (line.second[0] == '%') {
+      return process_directive(data, 1, line, current_macro, msgs);
+    }
 
-              macro_line.replace(index, param.size(), arg);
-              index += arg.size();
-            }
+    // Replace constants in line with their value
+    substitute_constants(data, line);
 
-            arg_index++;
-          }
+    // If in macro, add to body instead of the normal program
+    if (current_macro) {
+      current_macro->second.lines.push_back(std::move(line.second));
+      return true;
+    }
 
-          // Add modified macro line to program body
-          data.lines.insert(data.lines.begin() + insert_idx++, {old_line.first, macro_line});
-        }
+    // Extract mnemonic
+    int i = 0;
+    skip_non_whitespace(line.second, i);
+    std::string mnemonic = line.second.substr(0, i);
 
-        // We have inserted the macro's body now, so we continue
-        lines_idx--;
-      }
+    // Have we a macro?
+    auto macro_exists = data.macros.find(mnemonic);
+
+    if (macro_exists == data.macros.end()) {
+      data.lines.push_back(std::move(line));
+      return true;
     }
+
+    return expand_macro(data, line, mnemonic, i, macro_exists->second, 0, msgs);
   }
 
-  void process_directive(pre_processor::Data &data, int i, int line_idx, pre_processor::Line &line,
+  bool process_directive(pre_processor::Data &data, int i, pre_processor::Line &line,
                          std::pair<std::string, pre_processor::Macro> *&current_macro, message::List &msgs) {
     // Extract directive name
     int j = i;
@@ -247,12 +481,13 @@ namespace assembler {
                     << current_macro->second.lines.size() << " lines" << std::endl;
         }
 
+        current_macro->second.compile();
         current_macro = nullptr;
       } else {
         auto error = std::make_unique<message::Message>(message::Error, line.first);
         error->get() << "unknown/invalid directive in %macro body: %" << directive;
         msgs.add(std::move(error));
-        return;
+        return false;
       }
     } else {
       if (directive == "define") {
@@ -269,6 +504,14 @@ namespace assembler {
           std::cout << "\tConstant: " << constant;
         }
 
+        // Check if name is valid, as only whole identifiers are substituted
+        if (!is_valid_label_name(constant)) {
+          auto error = std::make_unique<message::Message>(message::Error, line.first.copy().column(j));
+          error->get() << "invalid constant name \"" << constant << "\"";
+          msgs.add(std::move(error));
+          return false;
+        }
+
         // Get value
         skip_whitespace(line.second, i);
         std::string value = line.second.substr(i);
@@ -294,6 +537,8 @@ namespace assembler {
           // Add to constant dictionary
           data.constants.insert({constant, {line.first.copy().column(j), value}});
         }
+
+        data.constants_version++;
       } else if (directive == "include") {
         // %include [FILEPATH]
         skip_non_whitespace(line.second, i);
@@ -332,14 +577,15 @@ namespace assembler {
           auto msg = std::make_unique<message::Message>(message::Note, line.first.copy().column(i));
           msg->get() << "attempted to %include file here";
           msgs.add(std::move(msg));
-          return;
+          return false;
         }
 
         // Now we know the file exists update data path
         include_data.file_path = full_path.string();
 
         // Check if the file has already been included
-        auto canonical_path = std::filesystem::canonical(full_path);
+        // the file need not exist on disk if read via a resolver
+        auto canonical_path = std::filesystem::weakly_canonical(full_path);
         auto circular_include = data.included_files.find(canonical_path);
 
         if (circular_include != data.included_files.end()) {
@@ -351,23 +597,57 @@ namespace assembler {
           msg->get() << "file " << canonical_path << " previously included here";
           msgs.add(std::move(msg));
 
-          return;
+          return false;
         }
 
         // Add to circular references map
         include_data.included_files.insert(data.included_files.begin(), data.included_files.end());
         include_data.included_files.insert({canonical_path, line.first.copy().column(i)});
 
-        // Pre-process included file
-        pre_process(include_data, include_messages);
+        // Load pre-processed file from the cache, else pre-process it and store the result
+        uint64_t content_hash = pre_processor::cache::hash(include_data.lines);
+        auto &cache_path = data.cli_args.cache_path;
+        uint64_t cache_key = 0;
+        bool cached = false;
 
-        if (include_messages.has_message_of(message::Error)) {
-          msgs.add(include_messages);
-          return;
+        if (!cache_path.empty()) {
+          include_data.executable = data.executable;
+          cache_key = pre_processor::cache::key(include_data, canonical_path, content_hash);
+          cached = pre_processor::cache::load(cache_path, cache_key, include_data);
+
+          if (data.cli_args.debug) {
+            std::cout << "\tCache " << (cached ? "hit" : "miss") << " for " << canonical_path << std::endl;
+          }
         }
 
-        // Merge data
-        data.merge(include_data, line_idx + 1);
+        if (!cached) {
+          pre_process(include_data, include_messages);
+
+          if (include_messages.has_message_of(message::Error)) {
+            msgs.add(include_messages);
+            return false;
+          }
+
+          if (!cache_path.empty()) {
+            pre_processor::cache::store(cache_path, cache_key, include_data);
+          }
+        }
+
+        // Record included files, so a cached entry which includes this one can be validated
+        data.dependencies.emplace_back(canonical_path, content_hash);
+        data.dependencies.insert(data.dependencies.end(), include_data.dependencies.begin(),
+                                 include_data.dependencies.end());
+        data.line_origins.insert(data.line_origins.end(), include_data.line_origins.begin(),
+                                 include_data.line_origins.end());
+
+        // Merge definitions, then pass the included lines through our pre-processor in place of this line
+        data.merge(include_data);
+
+        for (auto &include_line: include_data.lines) {
+          if (!pre_process_line(data, std::move(include_line), current_macro, msgs)) {
+            return false;
+          }
+        }
       } else if (directive == "macro") {
         // %macro [NAME] <args...>
         skip_alpha(line.second, i);
@@ -388,7 +668,7 @@ namespace assembler {
           auto error = std::make_unique<message::Message>(message::Error, line.first);
           error->get() << "invalid macro name \"" << macro_name << "\"";
           msgs.add(std::move(error));
-          return;
+          return false;
         }
 
         // Check if name already exists
@@ -431,7 +711,7 @@ namespace assembler {
             msg = std::make_unique<message::Message>(message::Note, line.first.copy().column(macro_name_index));
             msg->get() << "in definition of macro \"" << macro_name << '"';
             msgs.add(std::move(msg));
-            return;
+            return false;
           }
 
           // Duplicate parameter?
@@ -445,7 +725,7 @@ namespace assembler {
             msg = std::make_unique<message::Message>(message::Note, line.first.copy().column(macro_name_index));
             msg->get() << "in definition of macro \"" << macro_name + '"';
             msgs.add(std::move(msg));
-            return;
+            return false;
           }
 
           // Add top parameter list
@@ -471,6 +751,8 @@ namespace assembler {
           macro_exists->second.params = macro_params;
         }
 
+        macro_exists->second.constants_version = data.constants_version;
+
         // Set current_macro
         current_macro = reinterpret_cast<std::pair<std::string, pre_processor::Macro> *>(&*macro_exists);
       } else if (directive == "rm") {
@@ -479,20 +761,20 @@ namespace assembler {
           std::cout << "\tIgnoring this line.\n";
         }
       } else if (directive == "stop") {
-        // %stop: halt the pre-processor, remove all lines after this one
+        // %stop: halt the pre-processor, ignore all lines after this one
         if (data.cli_args.debug) {
-          std::cout << "\tRemoving all lines past line " << line_idx << "\n";
+          std::cout << "\tIgnoring all lines past line " << line.first.line() << "\n";
         }
 
-        while (data.lines.size() != line_idx) {
-          data.lines.pop_back();
-        }
+        return false;
       } else {
         auto msg = std::make_unique<message::Message>(message::Error, line.first);
         msg->get() << "unknown directive %" << directive;
         msgs.add(std::move(msg));
-        return;
+        return false;
       }
     }
+
+    return true;
   }
 }
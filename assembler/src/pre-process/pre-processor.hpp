@@ -1,21 +1,34 @@
 #pragma once
 
+#include <functional>
 #include "messages/list.hpp"
 #include "data.hpp"
 
 namespace assembler {
+  /** Read source lines from the stream, as if from the given file. */
+  void read_source(std::istream &stream, const std::filesystem::path &filepath, pre_processor::Data &data);
+
   /** Read source file provided in cli_args. */
   void read_source_file(pre_processor::Data &data, message::List &msgs);
 
   /** Read source file provided. */
-  void
-  read_source_file(const std::filesystem::path &filepath, pre_processor::Data &data, message::List &msgs, int line_no,
-                   int col_no);
+  void read_source_file(const std::filesystem::path &filepath, pre_processor::Data &data, message::List &msgs);
 
   /** Run pre-processing on the given data, mutating it, or add error. */
   void pre_process(pre_processor::Data &data, message::List &msgs);
 
-  /** Process a directive, starting from `index`. */
-  void process_directive(pre_processor::Data &data, int i, int line_idx, pre_processor::Line &line,
+  /**
+   * Replace each identifier in `line`, outside of string and character literals, for which `lookup` returns a value.
+   * `on_substitute` is called with the column, identifier and value of each substitution. Return the number made.
+   */
+  int substitute_symbols(std::string &line, const std::function<const std::string *(const std::string &)> &lookup,
+                         const std::function<void(int, const std::string &, const std::string &)> &on_substitute = nullptr);
+
+  /** Pre-process a single line, appending any output to `data.lines`. Return false if pre-processing should stop. */
+  bool pre_process_line(pre_processor::Data &data, pre_processor::Line line,
+                        std::pair<std::string, pre_processor::Macro> *&current_macro, message::List &msgs);
+
+  /** Process a directive, starting from `index`. Return false if pre-processing should stop. */
+  bool process_directive(pre_processor::Data &data, int i, pre_processor::Line &line,
                          std::pair<std::string, pre_processor::Macro> *&current_macro, message::List &msgs);
 }
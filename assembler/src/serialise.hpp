@@ -0,0 +1,42 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+namespace assembler::serialise {
+  /** Write the raw bytes of a value to the output stream. */
+  template<typename T>
+  void write_value(std::ostream &os, T value) {
+    os.write((const char *) &value, sizeof(value));
+  }
+
+  /** Read the raw bytes of a value from the input stream, return success. */
+  template<typename T>
+  bool read_value(std::istream &is, T &value) {
+    return (bool) is.read((char *) &value, sizeof(value));
+  }
+
+  /** Write a length-prefixed string to the output stream. */
+  inline void write_string(std::ostream &os, const std::string &str) {
+    write_value<uint32_t>(os, str.size());
+    os.write(str.data(), (std::streamsize) str.size());
+  }
+
+  /** Read a length-prefixed string from the input stream, return success. */
+  inline bool read_string(std::istream &is, std::string &str) {
+    uint32_t size;
+    if (!read_value(is, size)) return false;
+
+    // grow as bytes are read, so a corrupt size cannot allocate much more than the stream holds
+    str.clear();
+    while (str.size() < size) {
+      size_t offset = str.size(), chunk = std::min<size_t>(size - offset, 1 << 16);
+      str.resize(offset + chunk);
+      if (!is.read(str.data() + offset, (std::streamsize) chunk)) return false;
+    }
+
+    return true;
+  }
+}
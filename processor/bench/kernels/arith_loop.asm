@@ -0,0 +1,14 @@
+; tight arithmetic loop: accumulate (i * 3) ^ i for i in [0, 200000)
+main:
+    load $r1, 0         ; i
+    load $r2, 0         ; accumulator
+
+loop:
+    mul $r3, $r1, 3
+    xor $r3, $r1
+    add $r2, $r3
+    add $r1, 1
+    cmp $r1, 200000
+    blt loop
+
+    exit
@@ -0,0 +1,62 @@
+; function-call heavy code: recursive fib(20), using the compiler's calling convention
+; (arguments on the stack, $rpc and $fp saved by the caller, frame pointer in $fp)
+main:
+    sub $sp, 0x8        ; arg #1
+    load $r1, 20
+    store $r1, ($sp)
+    sub $sp, 0x8        ; save $rpc
+    store $rpc, ($sp)
+    sub $sp, 0x8        ; save $fp
+    store $fp, ($sp)
+    load $fp, $sp       ; push frame
+    jal fib
+    load $sp, $fp       ; restore frame
+    load $fp, ($sp)     ; restore $fp
+    load $rpc, 8($sp)   ; restore $rpc
+    add $sp, 0x18       ; stack clean-up
+    exit
+
+; fib(n: u64) -> u64
+fib:
+    load $r1, 16($fp)   ; n
+    cmp $r1, 2
+    bge fib_rec
+    load $ret, $r1
+    ret
+
+fib_rec:
+    sub $sp, 0x8        ; save fib(n - 1)
+    sub $r1, 1          ; fib(n - 1)
+    sub $sp, 0x8
+    store $r1, ($sp)
+    sub $sp, 0x8
+    store $rpc, ($sp)
+    sub $sp, 0x8
+    store $fp, ($sp)
+    load $fp, $sp
+    jal fib
+    load $sp, $fp
+    load $fp, ($sp)
+    load $rpc, 8($sp)
+    add $sp, 0x18
+    store $ret, ($sp)
+
+    load $r1, 16($fp)   ; fib(n - 2)
+    sub $r1, 2
+    sub $sp, 0x8
+    store $r1, ($sp)
+    sub $sp, 0x8
+    store $rpc, ($sp)
+    sub $sp, 0x8
+    store $fp, ($sp)
+    load $fp, $sp
+    jal fib
+    load $sp, $fp
+    load $fp, ($sp)
+    load $rpc, 8($sp)
+    add $sp, 0x18
+
+    load $r2, ($sp)
+    add $ret, $r2
+    add $sp, 0x8
+    ret
@@ -0,0 +1,31 @@
+; recursive factorial: compute 20! 2000 times
+main:
+    load $r10, 0        ; iteration counter
+
+again:
+    load $r1, 20
+    jal fact
+    add $r10, 1
+    cmp $r10, 2000
+    blt again
+
+    exit
+
+; fact($r1) -> $ret
+fact:
+    cmp $r1, 2
+    bge fact_rec
+    load $ret, 1
+    ret
+
+fact_rec:
+    sub $sp, 16
+    store $rpc, ($sp)
+    store $r1, 8($sp)
+    sub $r1, 1
+    jal fact
+    load $r1, 8($sp)
+    load $rpc, ($sp)
+    add $sp, 16
+    mul $ret, $r1
+    ret
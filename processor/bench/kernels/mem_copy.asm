@@ -0,0 +1,29 @@
+; memory copy: copy a 4KiB buffer word-by-word, 64 times over
+main:
+    load $r4, 0         ; pass counter
+
+pass:
+    load $r1, src       ; read pointer
+    load $r2, dst       ; write pointer
+    load $r3, 0         ; bytes copied
+
+copy:
+    load $r5, ($r1)
+    store $r5, ($r2)
+    add $r1, 8
+    add $r2, 8
+    add $r3, 8
+    cmp $r3, 4096
+    blt copy
+
+    add $r4, 1
+    cmp $r4, 64
+    blt pass
+
+    exit
+
+src:
+    .space 4096
+
+dst:
+    .space 4096
@@ -0,0 +1,300 @@
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "cpu.hpp"
+#include "debug.hpp"
+#include "named_fstream.hpp"
+#include "nullbuf.hpp"
+#include "messages/list.hpp"
+#include "assemble.hpp"
+#include "bench.hpp"
+
+// count every heap allocation made by the process, so we can report allocations per instruction
+static uint64_t allocation_count = 0;
+
+void *operator new(std::size_t size) {
+  allocation_count++;
+  if (void *ptr = std::malloc(size ? size : 1)) return ptr;
+  throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size) {
+  allocation_count++;
+  if (void *ptr = std::malloc(size ? size : 1)) return ptr;
+  throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+
+void operator delete[](void *ptr) noexcept { std::free(ptr); }
+
+void operator delete(void *ptr, std::size_t) noexcept { std::free(ptr); }
+
+void operator delete[](void *ptr, std::size_t) noexcept { std::free(ptr); }
+
+namespace bench {
+  // fixed set of kernels, located in the kernel directory as `<name>.asm`
+  const std::vector<std::string> kernels = {
+      "arith_loop", // tight arithmetic loop
+      "mem_copy", // word-by-word memory copy
+      "factorial", // recursive factorial
+      "call_heavy", // recursive fibonacci using the compiler's calling convention
+  };
+
+  // an execution mode the processor may be run under
+  struct Mode {
+    std::string name;
+    std::function<void(processor::CPU &)> configure;
+  };
+
+  const std::vector<Mode> modes = {
+      {"fast", [](processor::CPU &cpu) {
+        processor::debug::set_all(false);
+        cpu.fuse_compare_branch = false;
+      }},
+      {"fused", [](processor::CPU &cpu) {
+        processor::debug::set_all(false);
+        cpu.fuse_compare_branch = true;
+      }},
+      {"trace", [](processor::CPU &cpu) {
+        processor::debug::set_all(true);
+        cpu.fuse_compare_branch = false;
+      }},
+  };
+
+  // guard against runaway kernels
+  constexpr int max_instructions = 500'000'000;
+
+  struct Options {
+    std::filesystem::path kernel_dir = PROCESSOR_BENCH_KERNEL_DIR;
+    std::filesystem::path lib_path = PROCESSOR_BENCH_LIB_DIR;
+    std::filesystem::path output_path; // file to write JSON results to
+    std::unique_ptr<named_fstream> baseline_file; // JSON results to compare against
+    double threshold = 10.0; // percentage increase in ns/instruction which counts as a regression
+    int repeats = 5;
+    std::string filter; // only run kernels containing this string
+  };
+
+  struct Result {
+    std::string kernel;
+    std::string mode;
+    uint64_t instructions = 0;
+    double ns_per_instruction = 0;
+    double instructions_per_second = 0;
+    double allocations_per_instruction = 0;
+  };
+
+  // assemble the given kernel into a binary image, return success
+  bool assemble(const Options &opts, const std::string &kernel, std::string &image) {
+    std::filesystem::path path = opts.kernel_dir / (kernel + ".asm");
+    std::ifstream file(path);
+    if (!file.is_open()) {
+      std::cerr << kernel << ": failed to open file " << path << std::endl;
+      return false;
+    }
+
+    std::stringstream source;
+    source << file.rdbuf();
+
+    assembler::AssembleOptions options;
+    options.lib_path = opts.lib_path;
+    assembler::Assembly assembly = assembler::assemble(source.str(), path, options);
+    if (message::print_and_check(assembly.messages, std::cerr) || !assembly.success) return false;
+
+    image.assign(assembly.image.begin(), assembly.image.end());
+    return true;
+  }
+
+  // load the image into a freshly reset CPU
+  void load(processor::CPU &cpu, const std::string &image) {
+    cpu.fast_reset();
+    std::istringstream stream(image, std::ios::in | std::ios::binary);
+    processor::read_binary_file(cpu, stream);
+    cpu.reset_flag();
+  }
+
+  // run the CPU until it halts, return the number of instructions retired (a fused step retires several)
+  uint64_t run(processor::CPU &cpu) {
+    int count = 0;
+
+    while (cpu.is_running() && count < max_instructions) {
+      cpu.step(count);
+      cpu.clear_debug_messages();
+    }
+
+    return count;
+  }
+
+  // run a kernel under the given mode, taking the best of several repeats
+  bool measure(const Options &opts, const std::string &kernel, const std::string &image, const Mode &mode,
+               Result &result) {
+    static processor::CPU cpu;
+    static nullstream null_stream;
+    cpu.os = &null_stream;
+
+    result = {kernel, mode.name};
+    double best_ns = -1;
+
+    for (int i = 0; i < opts.repeats; i++) {
+      load(cpu, image);
+      mode.configure(cpu);
+
+      uint64_t allocations_before = allocation_count;
+      auto start = std::chrono::steady_clock::now();
+      uint64_t instructions = run(cpu);
+      auto end = std::chrono::steady_clock::now();
+      uint64_t allocations = allocation_count - allocations_before;
+      processor::debug::set_all(false);
+
+      if (cpu.is_running()) {
+        std::cerr << kernel << " (" << mode.name << "): did not halt within " << max_instructions << " instructions"
+                  << std::endl;
+        return false;
+      }
+
+      if (cpu.get_error() != constants::error::ok) {
+        std::cerr << kernel << " (" << mode.name << "): ";
+        cpu.print_error(std::cerr, false);
+        return false;
+      }
+
+      double ns = std::chrono::duration<double, std::nano>(end - start).count();
+      if (best_ns < 0 || ns < best_ns) {
+        best_ns = ns;
+        result.instructions = instructions;
+        result.ns_per_instruction = ns / (double) instructions;
+        result.instructions_per_second = (double) instructions * 1e9 / ns;
+        result.allocations_per_instruction = (double) allocations / (double) instructions;
+      }
+    }
+
+    return true;
+  }
+
+  void write_json(std::ostream &os, const std::vector<Result> &results) {
+    os << "{" << std::endl << "  \"results\": [" << std::endl;
+
+    // one result per line -- see `read_baseline`
+    for (size_t i = 0; i < results.size(); i++) {
+      const Result &r = results[i];
+      os << "    {\"kernel\": \"" << r.kernel << "\", \"mode\": \"" << r.mode << "\", \"instructions\": "
+         << r.instructions << std::fixed << std::setprecision(3) << ", \"ns_per_instruction\": "
+         << r.ns_per_instruction << ", \"instructions_per_second\": " << std::setprecision(0)
+         << r.instructions_per_second << ", \"allocations_per_instruction\": " << std::setprecision(3)
+         << r.allocations_per_instruction << "}" << (i + 1 < results.size() ? "," : "") << std::endl;
+      os << std::defaultfloat;
+    }
+
+    os << "  ]" << std::endl << "}" << std::endl;
+  }
+}
+
+int parse_arguments(int argc, char **argv, bench::Options &opts) {
+  for (int i = 1; i < argc; i++) {
+    std::string arg(argv[i]);
+
+    if (arg == "-o" || arg == "--baseline" || arg == "-k" || arg == "-l" || arg == "-r" || arg == "--threshold"
+        || arg == "--filter") {
+      if (++i >= argc) {
+        std::cerr << arg << ": expected a value.";
+        return EXIT_FAILURE;
+      }
+
+      if (arg == "-o") {
+        opts.output_path = argv[i];
+      } else if (arg == "--baseline") {
+        if (!(opts.baseline_file = named_fstream::open(argv[i], std::ios::in))) {
+          std::cerr << arg << ": failed to open file '" << argv[i] << "'";
+          return EXIT_FAILURE;
+        }
+      } else if (arg == "-k") {
+        opts.kernel_dir = argv[i];
+      } else if (arg == "-l") {
+        opts.lib_path = argv[i];
+      } else if (arg == "-r") {
+        opts.repeats = std::max(1, std::atoi(argv[i]));
+      } else if (arg == "--threshold") {
+        opts.threshold = std::atof(argv[i]);
+      } else {
+        opts.filter = argv[i];
+      }
+
+      continue;
+    }
+
+    std::cerr << "unknown argument " << arg;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+int main(int argc, char **argv) {
+  bench::Options opts;
+
+  if (parse_arguments(argc, argv, opts) != EXIT_SUCCESS) {
+    return EXIT_FAILURE;
+  }
+
+  // read the baseline now, as it may be the same file as the output
+  std::map<std::string, double> baseline;
+  if (opts.baseline_file)
+    baseline = bench::read_baseline(opts.baseline_file->stream, {"kernel", "mode"}, "ns_per_instruction");
+  opts.baseline_file = nullptr;
+
+  std::vector<bench::Result> results;
+  std::cout << std::left << std::setw(12) << "kernel" << std::setw(8) << "mode" << std::right << std::setw(12)
+            << "insts" << std::setw(12) << "ns/inst" << std::setw(14) << "inst/s" << std::setw(14) << "allocs/inst"
+            << std::endl;
+
+  for (const std::string &kernel : bench::kernels) {
+    if (kernel.find(opts.filter) == std::string::npos) continue;
+
+    std::string image;
+    if (!bench::assemble(opts, kernel, image)) return EXIT_FAILURE;
+
+    for (const bench::Mode &mode : bench::modes) {
+      bench::Result result;
+      if (!bench::measure(opts, kernel, image, mode, result)) return EXIT_FAILURE;
+
+      std::cout << std::left << std::setw(12) << result.kernel << std::setw(8) << result.mode << std::right
+                << std::setw(12) << result.instructions << std::fixed << std::setprecision(2) << std::setw(12)
+                << result.ns_per_instruction << std::setprecision(0) << std::setw(14)
+                << result.instructions_per_second << std::setprecision(2) << std::setw(14)
+                << result.allocations_per_instruction << std::defaultfloat << std::endl;
+      results.push_back(std::move(result));
+    }
+  }
+
+  if (!opts.output_path.empty()) {
+    auto file = named_fstream::open(opts.output_path, std::ios::out);
+    if (!file) {
+      std::cerr << "-o: failed to open file " << opts.output_path;
+      return EXIT_FAILURE;
+    }
+
+    bench::write_json(file->stream, results);
+    std::cout << "results written to " << file->path << std::endl;
+  }
+
+  std::vector<bench::Measurement> measurements;
+  for (const bench::Result &r : results) {
+    measurements.push_back({r.kernel + "/" + r.mode, r.kernel + " " + r.mode, r.ns_per_instruction});
+  }
+
+  if (!baseline.empty() && bench::compare(measurements, baseline, opts.threshold) > 0) {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,120 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "cpu.hpp"
+#include "debug.hpp"
+#include "nullbuf.hpp"
+
+namespace fuzz {
+  // guard against inputs which never halt
+  constexpr int max_instructions = 10'000;
+
+  // execute the given bytes as a binary file on a reset CPU
+  void run(const uint8_t *data, size_t size) {
+    static processor::CPU cpu;
+    static nullstream null_stream;
+    static std::istringstream input;
+
+    processor::debug::set_all(false);
+    input.clear();
+    cpu.os = &null_stream;
+    cpu.is = &input;
+
+    cpu.fast_reset();
+    std::istringstream stream(std::string((const char *) data, size), std::ios::in | std::ios::binary);
+    processor::read_binary_file(cpu, stream);
+    cpu.reset_flag();
+
+    for (int count = 0; cpu.is_running() && count < max_instructions;) {
+      cpu.step(count);
+    }
+
+    cpu.clear_debug_messages();
+  }
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+  fuzz::run(data, size);
+  return 0;
+}
+
+#ifndef PROCESSOR_FUZZ_LIBFUZZER
+// standalone driver, for when libFuzzer is not available:
+//   processor_fuzz <file|directory>...       replay the given inputs
+//   processor_fuzz [-runs <n>] [-seed <n>]   execute randomly generated inputs
+int main(int argc, char **argv) {
+  std::vector<std::filesystem::path> paths;
+  uint64_t runs = 100'000, seed = std::random_device()();
+
+  for (int i = 1; i < argc; i++) {
+    std::string arg(argv[i]);
+
+    if (arg == "-runs" || arg == "-seed") {
+      if (++i >= argc) {
+        std::cerr << arg << ": expected a value.";
+        return EXIT_FAILURE;
+      }
+
+      (arg == "-runs" ? runs : seed) = std::strtoull(argv[i], nullptr, 10);
+      continue;
+    }
+
+    if (std::filesystem::is_directory(arg)) {
+      for (const auto &entry : std::filesystem::directory_iterator(arg))
+        if (entry.is_regular_file()) paths.push_back(entry.path());
+    } else {
+      paths.emplace_back(arg);
+    }
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  uint64_t executed = 0;
+
+  if (!paths.empty()) {
+    for (const auto &path : paths) {
+      std::ifstream file(path, std::ios::in | std::ios::binary);
+      if (!file.is_open()) {
+        std::cerr << "failed to open file " << path << std::endl;
+        return EXIT_FAILURE;
+      }
+
+      std::string bytes{std::istreambuf_iterator<char>(file), {}};
+      LLVMFuzzerTestOneInput((const uint8_t *) bytes.data(), bytes.size());
+      executed++;
+    }
+  } else {
+    std::cout << "seed: " << seed << std::endl;
+    std::mt19937_64 random(seed);
+    std::vector<uint8_t> bytes;
+
+    for (; executed < runs; executed++) {
+      // a header, followed by up to 64 random instructions
+      size_t instructions = random() % 64;
+      bytes.resize(2 * sizeof(uint64_t) + instructions * sizeof(uint64_t));
+      for (size_t i = 0; i < bytes.size(); i += sizeof(uint64_t)) {
+        uint64_t word = random();
+        std::copy_n((const uint8_t *) &word, sizeof(word), bytes.begin() + i);
+      }
+
+      // usually start within the program, so we execute more than the first fetch
+      uint64_t entry = random() % 4 ? random() % (instructions + 1) * sizeof(uint64_t) : random();
+      std::copy_n((const uint8_t *) &entry, sizeof(entry), bytes.begin());
+
+      LLVMFuzzerTestOneInput(bytes.data(), bytes.size());
+    }
+  }
+
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  std::cout << "executed " << executed << " inputs in " << seconds << "s (" << (double) executed / seconds
+            << " exec/s)" << std::endl;
+  return EXIT_SUCCESS;
+}
+#endif
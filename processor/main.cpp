@@ -1,7 +1,11 @@
 #include "cpu.hpp"
 #include "debug.hpp"
+#include "lockstep.hpp"
 #include <iostream>
+#include <sstream>
+#include <iterator>
 #include "cli_arguments.hpp"
+#include "nullbuf.hpp"
 
 int parse_arguments(int argc, char **argv, processor::CliArguments &args) {
   for (int i = 1; i < argc; i++) {
@@ -53,6 +57,37 @@ int parse_arguments(int argc, char **argv, processor::CliArguments &args) {
           std::cerr << arg << ": expected 'yes' or 'no'.";
           return EXIT_FAILURE;
         }
+      } else if (arg == "--fuse-branches") {
+        if (++i >= argc) {
+          std::cerr << arg << ": expected a yes or no.";
+          return EXIT_FAILURE;
+        }
+
+        arg = argv[i];
+        if (arg == "yes" || arg == "y" || arg == "Y") {
+          args.fuse_branches = true;
+        } else if (arg == "no" || arg == "n" || arg == "N") {
+          args.fuse_branches = false;
+        } else {
+          std::cerr << arg << ": expected 'yes' or 'no'.";
+          return EXIT_FAILURE;
+        }
+      } else if (arg == "--lockstep") {
+        if (++i >= argc) {
+          std::cerr << arg << ": expected an instruction interval.";
+          return EXIT_FAILURE;
+        }
+
+        try {
+          args.lockstep_interval = std::stoull(argv[i]);
+        } catch (const std::exception &) {
+          args.lockstep_interval = 0;
+        }
+
+        if (args.lockstep_interval == 0) {
+          std::cerr << arg << ": expected a positive integer, got '" << argv[i] << "'";
+          return EXIT_FAILURE;
+        }
       } else if (arg == "-dall") {
         processor::debug::set_all(true);
       } else if (arg == "-dargs") {
@@ -168,6 +203,70 @@ static void handle_debug_message(const processor::debug::Message &msg) {
   }
 }
 
+static void print_debug_messages(processor::CPU &cpu) {
+  for (const auto &m : cpu.get_debug_messages())
+    handle_debug_message(*m);
+  cpu.clear_debug_messages();
+}
+
+// run the program on the reference CPU and a candidate engine side-by-side, return false if they diverged
+static bool run_lockstep(processor::CPU &cpu, std::istream &source, uint64_t interval) {
+  using namespace processor;
+
+  // both engines are fed identical copies of the program and its input
+  std::string image{std::istreambuf_iterator<char>(source), {}};
+  std::string input{std::istreambuf_iterator<char>(*cpu.is), {}};
+  std::istringstream reference_input, candidate_input;
+  std::ostream *output = cpu.os;
+  nullstream null_stream;
+
+  // the reference is always the plain interpreter, the candidate takes the configured engine options
+  CPU candidate;
+  candidate.fuse_compare_branch = cpu.fuse_compare_branch;
+  cpu.fuse_compare_branch = false;
+
+  auto load = [&](CPU &c, std::istringstream &is, std::ostream *os) {
+    is.str(input);
+    is.clear();
+    c.is = &is;
+    c.os = os;
+    c.fast_reset();
+    std::istringstream stream(image, std::ios::in | std::ios::binary);
+    read_binary_file(c, stream);
+    c.reset_flag();
+  };
+
+  load(cpu, reference_input, output);
+  load(candidate, candidate_input, &null_stream);
+  Lockstep lockstep(cpu, candidate, interval);
+
+  for (bool running = true; running;) {
+    running = lockstep.step();
+    print_debug_messages(cpu);
+    candidate.clear_debug_messages();
+  }
+
+  if (!lockstep.divergence().has_value()) return true;
+
+  // replay silently up to the last agreeing comparison, then compare after every instruction to pinpoint the divergence
+  if (interval > 1) {
+    debug::set_all(false);
+    load(cpu, reference_input, &null_stream);
+    load(candidate, candidate_input, &null_stream);
+
+    Lockstep replay(cpu, candidate, 1, lockstep.synced());
+    while (replay.step() && replay.instructions() < lockstep.instructions());
+
+    if (replay.divergence().has_value()) {
+      replay.print_divergence(std::cerr);
+      return false;
+    }
+  }
+
+  lockstep.print_divergence(std::cerr);
+  return false;
+}
+
 int main(int argc, char **argv) {
   using namespace processor;
 
@@ -181,6 +280,7 @@ int main(int argc, char **argv) {
 
   // initialise CPU and its streams
   CPU cpu;
+  cpu.fuse_compare_branch = args.fuse_branches;
   if (args.output_file) cpu.os = &args.output_file->stream;
   if (args.input_file) cpu.is = &args.input_file->stream;
   debug_stream = args.debug_file ? &args.debug_file->stream : &std::cout;
@@ -204,19 +304,19 @@ int main(int argc, char **argv) {
     return EXIT_FAILURE;
   }
 
-  // instantiate from file
-  read_binary_file(cpu, stream);
+  if (args.lockstep_interval > 0) {
+    if (!run_lockstep(cpu, stream, args.lockstep_interval)) return EXIT_FAILURE;
+  } else {
+    // instantiate from file
+    read_binary_file(cpu, stream);
 
-  // start processor
-  cpu.reset_flag();
+    // start processor
+    cpu.reset_flag();
 
-  for (int cnt = 0; cpu.is_running();) {
-    cpu.step(cnt);
-
-    // print debug messages
-    for (const auto &m : cpu.get_debug_messages())
-      handle_debug_message(*m);
-    cpu.clear_debug_messages();
+    for (int cnt = 0; cpu.is_running();) {
+      cpu.step(cnt);
+      print_debug_messages(cpu);
+    }
   }
 
   // print error (if any) and notify user of exit code
@@ -8,5 +8,7 @@ namespace processor {
     std::unique_ptr<named_fstream> input_file;
     std::unique_ptr<named_fstream> output_file;
     std::unique_ptr<named_fstream> debug_file;
+    bool fuse_branches = false; // execute cmp + conditional branch pairs as one step
+    uint64_t lockstep_interval = 0; // if non-zero, run alongside a candidate engine, comparing every n instructions
   };
 }
@@ -4,8 +4,9 @@
 #include <iostream>
 #include <iomanip>
 #include <fstream>
+#include <algorithm>
 
-void processor::Core::reset() {
+void processor::Core::reset_registers() {
   using namespace constants;
 
   // clear and configure key registers
@@ -13,11 +14,18 @@ void processor::Core::reset() {
   reg_set(registers::imr, 0xffffffffffffffff);
   reg_set(registers::sp, dram::size);
   reg_copy(registers::fp, registers::sp);
+}
 
-  // clear memory
+void processor::Core::reset() {
+  reset_registers();
   m_bus.mem.clear();
 }
 
+void processor::Core::fast_reset() {
+  reset_registers();
+  m_bus.mem.clear_dirty();
+}
+
 uint64_t processor::Core::reg(constants::registers::reg r, bool silent) {
   if (debug::reg && !silent) {
     auto msg = std::make_unique<debug::RegisterMessage>(r);
@@ -62,19 +70,24 @@ void processor::Core::mem_store(uint64_t addr, uint8_t size, uint64_t data) {
 
 void processor::Core::mem_copy(uint64_t source_addr, uint64_t dest_addr, uint32_t length) {
   char *mem_addr = (char *) m_bus.mem.data();
-  memcpy(mem_addr + dest_addr, mem_addr + source_addr, length);
+  m_bus.mem.mark_dirty(dest_addr, length);
+  memmove(mem_addr + dest_addr, mem_addr + source_addr, length);
 }
 
-void processor::Core::read(std::fstream &stream, size_t bytes) {
-  stream.read((char *) m_bus.mem.data(), bytes);
+void processor::Core::read(std::istream &stream, size_t bytes) {
+  stream.read((char *) m_bus.mem.data(), std::min<size_t>(bytes, dram::size));
+  m_bus.mem.mark_dirty(0, stream.gcount());
 }
 
 void processor::Core::read_string(uint64_t addr, uint32_t length) {
+  m_bus.mem.mark_dirty(addr, length);
   is->read((char *) (m_bus.mem.data() + addr), length);
 }
 
 void processor::Core::write_string(uint64_t addr) {
-  *os << (const char *) (m_bus.mem.data() + addr);
+  // stop at the end of memory if there is no null terminator
+  const char *string = (const char *) (m_bus.mem.data() + addr);
+  os->write(string, (std::streamsize) strnlen(string, dram::size - addr));
 }
 
 void processor::Core::print_registers() {
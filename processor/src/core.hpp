@@ -22,6 +22,9 @@ namespace processor {
     bus m_bus{}; // connected bus to access memory
     std::deque<std::unique_ptr<debug::Message>> debug_message;
 
+    // clear and configure registers
+    void reset_registers();
+
   public:
     std::ostream *os; // output stream
     std::istream *is; // input stream
@@ -40,6 +43,12 @@ namespace processor {
       if (on_add_debug_message.has_value()) on_add_debug_message.value()(*debug_message.back());
     }
 
+    // read-only view of the register file, does not generate debug messages
+    [[nodiscard]] const std::array<uint64_t, constants::registers::count> &registers() const { return m_regs; }
+
+    // read-only view of memory, does not generate debug messages
+    [[nodiscard]] const dram &memory() const { return m_bus.mem; }
+
     [[nodiscard]] uint64_t reg(constants::registers::reg r, bool silent = false);
 
     template<typename T>
@@ -72,6 +81,9 @@ namespace processor {
     // reset's the core, please call before use
     void reset();
 
+    // reset the core, only clearing memory which has been written to -- cheap for short programs
+    void fast_reset();
+
     // print contents of stack as hexadecimal bytes
     void print_stack();
 
@@ -81,8 +93,8 @@ namespace processor {
     // print region of memory, assume locations are valid
     void print_memory(uint64_t addr, uint32_t bytes);
 
-    // read data from the input stream into memory (starting at address 0x0)
-    void read(std::fstream &is, size_t bytes);
+    // read data from the input stream into memory (starting at address 0x0), truncated to the size of memory
+    void read(std::istream &is, size_t bytes);
   };
 
   // check if the given address is valid
@@ -3,6 +3,9 @@
 #include <iostream>
 #include <iomanip>
 #include <fstream>
+#include <cstring>
+#include <limits>
+#include <type_traits>
 
 #include "constants.hpp"
 #include "debug.hpp"
@@ -19,6 +22,22 @@ static constants::cmp::flag calculate_cmp_flag(LHS lhs, RHS rhs) {
   return static_cast<cmp::flag>(flag);
 }
 
+// reinterpret the bits of a value as a word, zero-filling any upper bytes
+template<typename T>
+static uint64_t to_word(T value) {
+  uint64_t word = 0;
+  memcpy(&word, &value, sizeof(T));
+  return word;
+}
+
+// check that integer division (or modulo) is defined for the given operands
+template<typename LHS, typename RHS>
+static bool is_division_defined(LHS lhs, RHS rhs) {
+  if (rhs == 0) return false;
+  if constexpr (std::is_signed_v<LHS> && std::is_signed_v<RHS>) return !(lhs == std::numeric_limits<LHS>::min() && rhs == -1);
+  return true;
+}
+
 void processor::CPU::raise_error(constants::error::code code, uint64_t val) {
   flag_reset(constants::flag::is_running);
   reg_set(constants::registers::flag,
@@ -179,7 +198,7 @@ void processor::CPU::exec_compare(uint64_t inst) {
       if (debug::errs)
         *os << ANSI_RED "unknown data type indicator: 0x" << std::hex << datatype << std::dec << std::endl
             << ANSI_RESET;
-      raise_error(error::datatype, datatype);
+      return raise_error(error::datatype, datatype);
   }
 
   // update flag bits in register
@@ -274,7 +293,8 @@ void processor::CPU::exec_shift_left(uint64_t inst) {
 
   if (!fetch_reg_reg_val(inst, reg_dst, reg_src, value, 0, false)) return;
 
-  reg_set(reg_dst, reg(reg_src) << value);
+  // shifting by the word size or more clears the register
+  reg_set(reg_dst, value < 64 ? reg(reg_src) << value : 0);
   if (debug::cpu) {
     auto msg = std::make_unique<debug::InstructionMessage>("shl");
     msg->stream() << "0x" << std::hex << reg(reg_src, true) << std::dec << " << " << value << " = 0x"
@@ -291,7 +311,7 @@ void processor::CPU::exec_shift_right(uint64_t inst) {
 
   if (!fetch_reg_reg_val(inst, reg_dst, reg_src, value, 0, false)) return;
 
-  reg_set(reg_dst, reg(reg_src) >> value);
+  reg_set(reg_dst, value < 64 ? reg(reg_src) >> value : 0);
   if (debug::cpu) {
     auto msg = std::make_unique<debug::InstructionMessage>("shr");
     msg->stream() << "0x" << std::hex << reg(reg_src, true) << std::dec << " >> " << value << " = 0x"
@@ -302,11 +322,14 @@ void processor::CPU::exec_shift_right(uint64_t inst) {
 }
 
 inline uint64_t zero_extend(uint64_t data, uint8_t size) {
+  if (size >= 64) return data;
   uint64_t mask = (1ull << size) - 1;
   return data & mask;
 }
 
 inline uint64_t sign_extend(uint64_t data, uint8_t size) {
+  if (size == 0) return 0;
+  if (size >= 64) return data;
   uint64_t msb = 1ull << (size - 1);
   return data & msb
          ? data | (~0ull << size)
@@ -316,6 +339,7 @@ inline uint64_t sign_extend(uint64_t data, uint8_t size) {
 // zest <reg> <value> <imm>
 void processor::CPU::exec_zero_extend(uint64_t inst) {
   auto reg = get_arg_reg(inst, constants::inst::header_size);
+  if (!is_running()) return;
   uint64_t value = get_arg_value(inst, constants::inst::header_size + constants::inst::reg_size, false);
   if (!is_running()) return;
   uint8_t size = inst >> (constants::inst::header_size + constants::inst::reg_size + constants::inst::value_size);
@@ -334,6 +358,7 @@ void processor::CPU::exec_zero_extend(uint64_t inst) {
 // sext <reg> <value> <imm>
 void processor::CPU::exec_sign_extend(uint64_t inst) {
   auto reg = get_arg_reg(inst, constants::inst::header_size);
+  if (!is_running()) return;
   uint64_t value = get_arg_value(inst, constants::inst::header_size + constants::inst::reg_size, false);
   if (!is_running()) return;
   uint8_t size = inst >> (constants::inst::header_size + constants::inst::reg_size + constants::inst::value_size);
@@ -350,7 +375,8 @@ void processor::CPU::exec_sign_extend(uint64_t inst) {
 }
 
 // macro for arithmetic operation
-#define ARITH_OPERATION(MNEMONIC, OPERATOR, INJECT) \
+// GUARD is run before an integer operation, with `lhs` and `rhs` in scope
+#define ARITH_OPERATION(MNEMONIC, OPERATOR, GUARD, INJECT) \
   auto datatype = static_cast<constants::inst::datatype::dt>((inst >> constants::inst::header_size) & 0x7);\
   constants::registers::reg reg_src, reg_dst;\
   uint64_t value, result; \
@@ -363,6 +389,7 @@ void processor::CPU::exec_sign_extend(uint64_t inst) {
     case constants::inst::datatype::u64: {\
       auto lhs = reg(reg_src);                                    \
       auto rhs = *(int32_t *) &value;\
+      GUARD                                                       \
       auto res = lhs OPERATOR rhs;                  \
       result = res;                                    \
       if (debug::cpu) *ds << lhs << " " #OPERATOR " " << rhs << " = " << res << std::endl;\
@@ -371,6 +398,7 @@ void processor::CPU::exec_sign_extend(uint64_t inst) {
     case constants::inst::datatype::u32: {\
       auto lhs = reg<uint32_t>(reg_src);\
       auto rhs = *(int32_t *) &value;\
+      GUARD                                                       \
       auto res = lhs OPERATOR rhs;      \
       result = res;                                    \
       if (debug::cpu) *ds << lhs << " " #OPERATOR " " << rhs << " = " << res << std::endl;\
@@ -379,26 +407,29 @@ void processor::CPU::exec_sign_extend(uint64_t inst) {
     case constants::inst::datatype::s64: {\
       auto lhs = reg<int64_t>(reg_src);\
       auto rhs = *(int32_t *) &value;\
+      GUARD                                                       \
       int64_t res = lhs OPERATOR rhs;\
-      result = *(uint64_t *) &res;\
+      result = to_word(res);\
       if (debug::cpu) *ds << lhs << " " #OPERATOR " " << rhs << " = " << res << std::endl;\
     }\
     break;\
     case constants::inst::datatype::s32: {\
-      auto lhs = reg<int32_t>(reg_src), rhs = *(int32_t *) &value, res = lhs + rhs;\
-      result = *(uint64_t *) &res;\
+      auto lhs = reg<int32_t>(reg_src), rhs = *(int32_t *) &value;\
+      GUARD                                                       \
+      auto res = lhs + rhs;\
+      result = to_word(res);\
       if (debug::cpu) *ds << lhs << " " #OPERATOR " " << rhs << " = " << res << std::endl;\
     }\
     break;\
     case constants::inst::datatype::flt: {\
       auto lhs = reg<float>(reg_src), rhs = *(float *) &value, res = lhs OPERATOR rhs;\
-      result = *(uint64_t *) &res;\
+      result = to_word(res);\
       if (debug::cpu) *ds << lhs << " " #OPERATOR " " << rhs << " = " << res << std::endl;\
     }\
     break;\
     case constants::inst::datatype::dbl: {\
       auto lhs = reg<double>(reg_src), rhs = *(double *) &value, res = lhs OPERATOR rhs;\
-      result = *(uint64_t *) &res;\
+      result = to_word(res);\
       if (debug::cpu) *ds << lhs << " " #OPERATOR " " << rhs << " = " << res << std::endl;\
     }\
     break;\
@@ -413,22 +444,22 @@ void processor::CPU::exec_sign_extend(uint64_t inst) {
 
 // add <reg> <reg> <value>
 void processor::CPU::exec_add(uint64_t inst) {
-  ARITH_OPERATION("add",+,)
+  ARITH_OPERATION("add",+,,)
 }
 
 // sub <reg> <reg> <value>
 void processor::CPU::exec_sub(uint64_t inst) {
-  ARITH_OPERATION("sub",-,)
+  ARITH_OPERATION("sub",-,,)
 }
 
 // mul <reg> <reg> <value>
 void processor::CPU::exec_mul(uint64_t inst) {
-  ARITH_OPERATION("mul",*,)
+  ARITH_OPERATION("mul",*,,)
 }
 
 // div <reg> <reg> <value>
 void processor::CPU::exec_div(uint64_t inst) {
-  ARITH_OPERATION("div",/,)
+  ARITH_OPERATION("div",/,if (!is_division_defined(lhs, rhs)) return raise_error(constants::error::arithmetic, rhs);,)
 }
 
 // mod <reg> <value> <value>
@@ -441,6 +472,7 @@ void processor::CPU::exec_mod(uint64_t inst) {
 
   auto lhs = reg<int64_t>(reg_src);
   auto rhs = *(int32_t *) &value;
+  if (!is_division_defined(lhs, rhs)) return raise_error(constants::error::arithmetic, rhs);
   int64_t result = lhs % rhs;
   reg_set(reg_dst, result);
 
@@ -492,7 +524,7 @@ void processor::CPU::exec_syscall(uint64_t inst) {
       break;
     case syscall::print_string: {
       if (msg) msg->stream() << "print_string)";
-      uint32_t addr = reg(reg_start);
+      uint64_t addr = reg(reg_start);
       if (!check_memory(addr)) return raise_error(error::segfault, addr);
       write_string(addr);
       break;
@@ -528,7 +560,7 @@ void processor::CPU::exec_syscall(uint64_t inst) {
     case syscall::read_string: {
       if (msg) msg->stream() << "read_string)";
       uint64_t addr = reg(reg_start), length = reg(static_cast<registers::reg>(reg_start + 1));
-      if (!check_memory(addr)) return raise_error(error::segfault, addr);
+      if (!check_memory(addr, length)) return raise_error(error::segfault, addr);
       read_string(addr, length);
       break;
     }
@@ -541,6 +573,8 @@ void processor::CPU::exec_syscall(uint64_t inst) {
       uint64_t src = reg(reg_start),
         dst = reg(static_cast<registers::reg>(reg_start + 1)),
         length = reg(static_cast<registers::reg>(reg_start + 2));
+      if (!check_memory(src, length)) return raise_error(error::segfault, src);
+      if (!check_memory(dst, length)) return raise_error(error::segfault, dst);
       mem_copy(src, dst, length);
       break;
     }
@@ -551,15 +585,17 @@ void processor::CPU::exec_syscall(uint64_t inst) {
     case syscall::print_mem: {
       if (msg) msg->stream() << "print_mem)";
       uint64_t addr = reg(reg_start), size = reg(static_cast<registers::reg>(reg_start + 1));
-      if (!check_memory(addr)) return raise_error(error::segfault, addr);
-      if (!check_memory(addr + size - 1)) return raise_error(error::segfault, addr + size - 1);
+      if (!check_memory(addr, size)) return raise_error(error::segfault, addr);
       print_memory(addr, size);
       break;
     }
-    case syscall::print_stack:
+    case syscall::print_stack: {
       if (debug::cpu) *os << "print_stack)";
+      uint64_t sp = reg(registers::sp);
+      if (sp > dram::size) return raise_error(error::segfault, sp);
       print_stack();
       break;
+    }
     default:
       if (msg) msg->stream() << "unknown)";
       if (debug::errs)
@@ -573,8 +609,11 @@ void processor::CPU::exec_syscall(uint64_t inst) {
 
 template<typename T>
 void processor::CPU::push(T val) {
-  reg_set(constants::registers::sp, reg(constants::registers::sp) - sizeof(val));
-  mem_store(reg(constants::registers::sp), sizeof(val), val);
+  uint64_t addr = reg(constants::registers::sp) - sizeof(val);
+  if (!check_memory(addr)) return raise_error(constants::error::segfault, addr);
+
+  reg_set(constants::registers::sp, addr);
+  mem_store(addr, sizeof(val), val);
 }
 
 // push <value>
@@ -619,7 +658,7 @@ static uint64_t cast_value(constants::inst::datatype::dt dt, T src) {
   switch (dt) {
     case u32: {
       uint32_t tmp = src;
-      return *(uint64_t *) &tmp;
+      return to_word(tmp);
     }
     case u64: {
       uint64_t tmp = src;
@@ -627,19 +666,19 @@ static uint64_t cast_value(constants::inst::datatype::dt dt, T src) {
     }
     case s32: {
       int32_t tmp = src;
-      return *(uint64_t *) &tmp;
+      return to_word(tmp);
     }
     case s64: {
       int64_t tmp = src;
-      return *(uint64_t *) &tmp;
+      return to_word(tmp);
     }
     case flt: {
       float tmp = src;
-      return *(uint64_t *) &tmp;
+      return to_word(tmp);
     }
     case dbl: {
       double tmp = src;
-      return *(uint64_t *) &tmp;
+      return to_word(tmp);
     }
     default:
       return 0;
@@ -658,6 +697,7 @@ void processor::CPU::exec_convert(uint64_t inst) {
   // extra source and destination registers
   constants::registers::reg reg_dst = get_arg_reg(inst, pos += datatype::size);
   constants::registers::reg reg_src = get_arg_reg(inst, pos += reg_size);
+  if (!is_running()) return;
 
   uint64_t value = reg(reg_src);
   switch (d1) {
@@ -696,11 +736,16 @@ void processor::CPU::exec_convert(uint64_t inst) {
 static int current_arg_num = 0; // for debugging, track which argument we are on
 
 constants::registers::reg processor::CPU::_arg_reg(uint32_t data, std::unique_ptr<debug::ArgumentMessage>& debug_msg) {
+  auto reg = static_cast<constants::registers::reg>(data & 0xff);
+
   if (debug::args) {
     debug_msg = std::make_unique<debug::ArgumentMessage>(constants::inst::arg::reg, current_arg_num);
-    debug_msg->stream() << "$" << constants::registers::to_string(static_cast<constants::registers::reg>(data));
+    debug_msg->stream() << "$" << constants::registers::to_string(reg);
   }
-  return static_cast<constants::registers::reg>(data);
+
+  // callers must check `is_running()` before using the register
+  if (!check_register(reg)) raise_error(constants::error::reg, reg);
+  return reg;
 }
 
 uint32_t processor::CPU::_arg_addr(uint32_t data, std::unique_ptr<debug::ArgumentMessage>& debug_msg) {
@@ -777,10 +822,13 @@ uint64_t processor::CPU::get_arg_value(uint64_t word, uint8_t pos, bool cast_imm
       result = mem_load(_arg_addr(data, msg), sizeof(uint64_t));
       if (msg) msg->value = result;
       break;
-    case arg::reg:
-      result = reg(_arg_reg(data, msg));
+    case arg::reg: {
+      auto reg = _arg_reg(data, msg);
+      if (!is_running()) return 0;
+      result = this->reg(reg);
       if (msg) msg->value = result;
       break;
+    }
     case arg::reg_indirect:
       result = mem_load(_arg_reg_indirect(data, msg), sizeof(uint64_t));
       if (msg) msg->value = result;
@@ -856,30 +904,13 @@ void processor::CPU::execute(uint64_t inst) {
     std::unique_ptr<debug::ConditionalMessage> msg = debug::conditionals
         ? std::make_unique<debug::ConditionalMessage>(test_bits)
         : nullptr;
-    bool fail = false;
-
-    // extract cmp bits from both the instruction and the flag register
-    auto flag_bits = static_cast<cmp::flag>(reg(registers::flag) & cmp_bits);
 
-    // special case for [N]Z test, otherwise compare directly
-    if (test_bits == cmp::z || test_bits == cmp::nz) {
-      bool zero_flag = flag_test(flag::zero);
-
-      if ((test_bits == cmp::nz && zero_flag) || (test_bits == cmp::z && !zero_flag)) {
-        fail = true;
-      }
-    } else {
-      // compare the base cmp bits
-      bool result = (test_bits & 0x3) == (flag_bits & 0x3);
-      if (test_bits & 0b100) result = !result; // inverse test?
-
-      if (!result) {
-        fail = true;
-      }
-    }
+    // extract cmp bits from the flag register
+    uint64_t flag_reg = reg(registers::flag);
+    auto flag_bits = static_cast<cmp::flag>(flag_reg & cmp_bits);
 
     // update message
-    if (fail) {
+    if (!test_condition(test_bits, flag_reg)) {
       if (msg) {
         msg->fail(flag_bits);
         add_debug_message(std::move(msg));
@@ -891,6 +922,28 @@ void processor::CPU::execute(uint64_t inst) {
     }
   }
 
+  dispatch(inst);
+}
+
+bool processor::CPU::test_condition(constants::cmp::flag test_bits, uint64_t flag_reg) {
+  using namespace constants;
+
+  // special case for [N]Z test, otherwise compare directly
+  if (test_bits == cmp::z || test_bits == cmp::nz) {
+    bool zero_flag = flag_test(flag_reg, flag::zero);
+    return test_bits == cmp::z ? zero_flag : !zero_flag;
+  }
+
+  // compare the base cmp bits
+  bool result = (test_bits & 0x3) == (flag_reg & 0x3);
+  if (test_bits & 0b100) result = !result; // inverse test?
+  return result;
+}
+
+void processor::CPU::dispatch(uint64_t inst) {
+  using namespace constants;
+  auto opcode = static_cast<inst::op>(inst & inst::op_mask);
+
   switch (opcode) {
     case inst::_load:
       return exec_load(inst);
@@ -986,6 +1039,33 @@ void processor::CPU::step(int &step) {
   // finally, execute the instruction
   execute(inst);
   step++;
+
+  // the compiler follows nearly every cmp with a conditional branch, so execute that now
+  if (fuse_compare_branch && (inst & constants::inst::op_mask) == constants::inst::_compare && !debug::any()
+      && step_fused_branch())
+    step++;
+}
+
+bool processor::CPU::step_fused_branch() {
+  using namespace constants;
+
+  // an interrupt would be taken before the branch, so defer to the next step
+  uint64_t pc = reg(registers::pc, true);
+  if (!is_running() || is_interrupt() || !check_memory(pc)) return false;
+
+  // is this a conditional `jal` or `load $pc`?
+  uint64_t inst = mem_load(pc, sizeof(uint64_t));
+  auto opcode = static_cast<inst::op>(inst & inst::op_mask);
+  auto test_bits = static_cast<cmp::flag>((inst >> inst::cmp_offset) & inst::cmp_mask);
+  bool is_branch = opcode == inst::_jal
+      || (opcode == inst::_load && ((inst >> inst::header_size) & 0xff) == registers::pc);
+  if (test_bits == cmp::na || !is_branch) return false;
+
+  // test the flag cmp has just written, skipping the fetch and decode of a separate step
+  reg_set(registers::pc, pc + sizeof(inst), true);
+  current_arg_num = 0;
+  if (test_condition(test_bits, reg(registers::flag, true))) dispatch(inst);
+  return true;
 }
 
 void processor::CPU::step_cycle() {
@@ -1026,12 +1106,16 @@ void processor::CPU::print_error(std::ostream &os, bool prefix) {
       os << "E-DATATYPE: invalid datatype specifier 0x" << std::hex << reg(registers::ret) << std::dec
          << " (at $pc=0x" << reg(registers::pc) << ")" << std::endl;
       break;
+    case error::arithmetic:
+      os << "E-ARITH: undefined integer division by 0x" << std::hex << reg(registers::ret) << " (at $pc=0x"
+         << reg(registers::pc) << ")" << std::dec << std::endl;
+      break;
     default:
       os << "E-UNKNOWN: unknown error, $ret=0x" << std::hex << reg(registers::ret) << std::dec << std::endl;
   }
 }
 
-void processor::read_binary_file(CPU &cpu, std::fstream &stream) {
+void processor::read_binary_file(CPU &cpu, std::istream &stream) {
   // determine file size
   auto cur = stream.tellg();
   stream.seekg(-1, std::ios::end);
@@ -107,7 +107,16 @@ namespace processor {
 
     void exec_syscall(uint64_t inst);
 
+    // execute the instruction's operation, ignoring any conditional test
+    void dispatch(uint64_t inst);
+
+    // called after a cmp: if the next instruction is a conditional branch, execute it too and return true
+    bool step_fused_branch();
+
   public:
+    // execute cmp + conditional branch pairs as a single step (ignored while any debug flag is set)
+    bool fuse_compare_branch = false;
+
     CPU() : Core(), addr_interrupt_handler(constants::default_interrupt_handler) {}
 
     void set_interrupt_handler(uint64_t addr) { addr_interrupt_handler = addr; }
@@ -161,13 +170,21 @@ namespace processor {
 
     void print_error(bool prefix) { print_error(*os, prefix); }
 
+    // does the conditional test pass, given the contents of $flag?
+    [[nodiscard]] static bool test_condition(constants::cmp::flag test_bits, uint64_t flag_reg);
+
     // check if the given address is valid
     [[nodiscard]] static bool check_memory(uint64_t addr) { return addr < dram::size; }
 
+    // check if the `bytes`-long region starting at the given address is valid
+    [[nodiscard]] static bool check_memory(uint64_t addr, uint64_t bytes) {
+      return addr < dram::size && bytes <= dram::size - addr;
+    }
+
     // check if the given register is valid
     [[nodiscard]] static bool check_register(uint8_t off) { return off < constants::registers::count; }
   };
 
   /** Read binary file into CPU, use to configure program. */
-  void read_binary_file(CPU &cpu, std::fstream &stream);
+  void read_binary_file(CPU &cpu, std::istream &stream);
 }
\ No newline at end of file
@@ -38,6 +38,8 @@ namespace processor::debug {
     Type type;
 
     explicit Message(Type type) : type(type) {}
+
+    virtual ~Message() = default;
   };
 
   struct CycleMessage : Message {
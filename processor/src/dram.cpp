@@ -1,11 +1,13 @@
 #include <cstring>
 #include <iostream>
+#include <algorithm>
 #include "dram.hpp"
 
 uint64_t processor::dram::load(uint64_t addr, uint8_t bytes) const {
   uint64_t data = 0;
 
-  for (int i = 0, sh = 0; i < bytes; i++, sh += 8) {
+  // bytes beyond the end of memory read as zero
+  for (int i = 0, sh = 0; i < bytes && addr + i < size; i++, sh += 8) {
     data |= (uint64_t) mem[addr + i] << sh;
   }
 
@@ -13,11 +15,45 @@ uint64_t processor::dram::load(uint64_t addr, uint8_t bytes) const {
 }
 
 void processor::dram::store(uint64_t addr, uint8_t bytes, uint64_t value) {
-  for (int i = 0, sh = 0; i < bytes; i++, sh += 8) {
+  mark_dirty(addr, bytes);
+
+  // bytes beyond the end of memory are discarded
+  for (int i = 0, sh = 0; i < bytes && addr + i < size; i++, sh += 8) {
     mem[addr + i] = (uint8_t) (value >> sh & 0xff);
   }
 }
 
 void processor::dram::clear() {
   memset(mem.data(), 0, mem.size());
+  m_dirty.reset();
+}
+
+void processor::dram::clear_dirty() {
+  for (uint64_t page = 0; page < page_count; page++) {
+    if (m_dirty[page]) memset(mem.data() + page * page_size, 0, page_size);
+  }
+
+  m_dirty.reset();
+}
+
+void processor::dram::mark_dirty(uint64_t addr, uint64_t bytes) {
+  if (bytes == 0 || addr >= size) return;
+
+  uint64_t last = std::min(addr + bytes, size) - 1;
+  for (uint64_t page = addr / page_size; page <= last / page_size; page++) {
+    m_dirty.set(page);
+  }
+}
+
+uint64_t processor::dram::hash_page(uint64_t page) const {
+  // FNV-1a, consuming a word at a time
+  uint64_t hash = 0xcbf29ce484222325;
+  const auto *words = (const uint64_t *) (mem.data() + page * page_size);
+
+  for (uint64_t i = 0; i < page_size / sizeof(uint64_t); i++) {
+    hash ^= words[i];
+    hash *= 0x100000001b3;
+  }
+
+  return hash;
 }
@@ -2,6 +2,7 @@
 
 #include <cstdint>
 #include <array>
+#include <bitset>
 
 namespace processor {
   class dram {
@@ -9,13 +10,18 @@ namespace processor {
     // DRAM size - 1MiB
     static constexpr uint64_t size = 1024 * 1024;
 
+    // page size used for dirty tracking - 4KiB
+    static constexpr uint64_t page_size = 4096;
+    static constexpr uint64_t page_count = size / page_size;
+
   private:
-    std::array<uint8_t, size> mem;
+    std::array<uint8_t, size> mem{};
+    std::bitset<page_count> m_dirty; // pages written to since the last clear, all other pages are zero
 
   public:
     dram() = default;
 
-    // get pointer to base data
+    // get pointer to base data, writes through this must be marked with `mark_dirty`
     uint8_t *data() { return mem.data(); }
 
     // load a word of given size from memory
@@ -27,6 +33,18 @@ namespace processor {
     // clear DRAM memory
     void clear();
 
+    // clear only those pages which have been written to
+    void clear_dirty();
+
+    // mark the pages covering [addr, addr + bytes) as dirty
+    void mark_dirty(uint64_t addr, uint64_t bytes);
+
+    // get pages written to since the last clear
+    [[nodiscard]] const std::bitset<page_count> &dirty_pages() const { return m_dirty; }
+
+    // hash the contents of the given page
+    [[nodiscard]] uint64_t hash_page(uint64_t page) const;
+
     uint8_t &operator[](std::size_t index) {
       return mem[index];
     }
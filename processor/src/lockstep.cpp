@@ -0,0 +1,119 @@
+#include "lockstep.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <sstream>
+#include "shell.hpp"
+
+processor::Lockstep::Lockstep(CPU &reference, CPU &candidate, uint64_t interval, uint64_t skip)
+    : m_reference(reference), m_candidate(candidate), m_interval(std::max<uint64_t>(interval, 1)) {
+  m_next_sync = std::max(m_interval, skip);
+}
+
+std::string processor::Lockstep::compare() const {
+  std::stringstream reason;
+
+  // compare register files
+  const auto &ref_regs = m_reference.registers(), &cand_regs = m_candidate.registers();
+  for (int i = 0; i < constants::registers::count; i++) {
+    if (ref_regs[i] != cand_regs[i]) {
+      reason << "register $" << constants::registers::to_string(constants::registers::reg(i)) << " differs (reference 0x"
+             << std::hex << ref_regs[i] << ", candidate 0x" << cand_regs[i] << ")";
+      return reason.str();
+    }
+  }
+
+  // compare the set of pages written to, then their contents
+  const dram &ref_mem = m_reference.memory(), &cand_mem = m_candidate.memory();
+  const auto &dirty = ref_mem.dirty_pages();
+
+  for (uint64_t page = 0; page < dram::page_count; page++) {
+    if (dirty[page] != cand_mem.dirty_pages()[page]) {
+      reason << "page 0x" << std::hex << page * dram::page_size << " was only written to by the "
+             << (dirty[page] ? "reference" : "candidate");
+      return reason.str();
+    }
+
+    if (dirty[page] && ref_mem.hash_page(page) != cand_mem.hash_page(page)) {
+      reason << "contents of page 0x" << std::hex << page * dram::page_size << " differ";
+      return reason.str();
+    }
+  }
+
+  return "";
+}
+
+// execute a step, return the new number of instructions retired
+// CPU::step counts in an int for its debug output, so it is given a copy which cannot overflow
+static uint64_t retire(processor::CPU &cpu, uint64_t count) {
+  int start = (int) std::min<uint64_t>(count, INT_MAX - 2), step = start;
+  cpu.step(step);
+  return count + (step - start);
+}
+
+bool processor::Lockstep::step() {
+  if (m_divergence.has_value()) return false;
+
+  bool reference_running = m_reference.is_running();
+  if (reference_running) {
+    uint64_t pc = m_reference.read_pc();
+    m_window.push_back({pc, CPU::check_memory(pc + sizeof(uint64_t) - 1) ? m_reference.memory().load(pc, sizeof(uint64_t)) : 0});
+    uint64_t count = m_reference_count;
+    m_reference_count = retire(m_reference, count);
+
+    // the reference halted without retiring (e.g., a fault on fetch), so the candidate must do the same
+    if (m_reference_count == count && !m_reference.is_running() && m_candidate.is_running()
+        && m_candidate_count == count) {
+      m_candidate_count = retire(m_candidate, m_candidate_count);
+    }
+  }
+
+  // catch the candidate up, it may retire several instructions at once
+  while (m_candidate.is_running() && m_candidate_count < m_reference_count) {
+    m_candidate_count = retire(m_candidate, m_candidate_count);
+  }
+
+  // wait for the reference to catch up with the candidate
+  if (m_reference.is_running() && m_reference_count < m_candidate_count) return true;
+
+  bool aligned = m_reference_count == m_candidate_count;
+  bool halted = !m_reference.is_running() || !m_candidate.is_running();
+  if (aligned && !halted && m_reference_count < m_next_sync) return true;
+
+  std::string reason;
+  if (aligned) {
+    reason = compare();
+  } else {
+    std::stringstream stream;
+    stream << "reference halted after " << m_reference_count << " instructions, candidate after " << m_candidate_count;
+    reason = stream.str();
+  }
+
+  if (!reason.empty()) {
+    m_divergence = {m_reference_count, reason};
+    return false;
+  }
+
+  m_synced = m_reference_count;
+  m_next_sync = m_synced + m_interval;
+  m_window.clear();
+  return !halted;
+}
+
+void processor::Lockstep::print_divergence(std::ostream &os) const {
+  if (!m_divergence.has_value()) return;
+
+  os << ERROR_STR " lockstep: engines diverged after " << m_divergence->instructions << " instructions: "
+     << m_divergence->reason << std::endl;
+
+  if (m_window.empty()) return;
+
+  os << std::hex;
+  if (m_window.size() == 1) {
+    os << "first diverging instruction: $pc=0x" << m_window.front().pc << ", inst=0x" << m_window.front().inst;
+  } else {
+    os << "divergence lies within the " << std::dec << m_window.size() << std::hex
+       << " instructions starting at $pc=0x" << m_window.front().pc << ", inst=0x" << m_window.front().inst;
+  }
+  os << std::dec << std::endl;
+}
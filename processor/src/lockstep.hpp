@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <ostream>
+#include <string>
+#include "cpu.hpp"
+
+namespace processor {
+  /**
+   * Runs a reference CPU and a candidate CPU side-by-side.
+   * Every `interval` instructions, their register files and the hashes of the memory pages they have written to are compared.
+   * Both CPUs must have been loaded with the same program and input before stepping.
+   */
+  class Lockstep {
+  public:
+    struct Divergence {
+      uint64_t instructions; // instructions retired by the reference when the divergence was detected
+      std::string reason; // description of the first difference found
+    };
+
+    // an instruction executed by the reference CPU
+    struct Executed {
+      uint64_t pc;
+      uint64_t inst;
+    };
+
+  private:
+    CPU &m_reference;
+    CPU &m_candidate;
+    uint64_t m_interval;
+    uint64_t m_reference_count = 0; // instructions retired by the reference
+    uint64_t m_candidate_count = 0; // instructions retired by the candidate, which may retire several per step
+    uint64_t m_next_sync; // compare states once this many instructions have been retired
+    uint64_t m_synced = 0; // instructions retired at the last comparison which agreed
+    std::deque<Executed> m_window; // instructions executed by the reference since the last comparison
+    std::optional<Divergence> m_divergence;
+
+    // compare the states of both CPUs, return a description of the first difference (empty if identical)
+    [[nodiscard]] std::string compare() const;
+
+  public:
+    // do not compare states until `skip` instructions have been retired
+    Lockstep(CPU &reference, CPU &candidate, uint64_t interval, uint64_t skip = 0);
+
+    // execute an instruction on the reference and catch the candidate up to it
+    // returns false once both have halted, or they have diverged
+    bool step();
+
+    [[nodiscard]] uint64_t instructions() const { return m_reference_count; }
+
+    [[nodiscard]] uint64_t synced() const { return m_synced; }
+
+    [[nodiscard]] const std::deque<Executed> &window() const { return m_window; }
+
+    [[nodiscard]] const std::optional<Divergence> &divergence() const { return m_divergence; }
+
+    // print details of the divergence (if any)
+    void print_divergence(std::ostream &os) const;
+  };
+}
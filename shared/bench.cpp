@@ -0,0 +1,65 @@
+#include "bench.hpp"
+
+#include <iomanip>
+
+#include "shell.hpp"
+
+namespace bench {
+  std::string json_field(const std::string &line, const std::string &key) {
+    size_t i = line.find("\"" + key + "\":");
+    if (i == std::string::npos) return "";
+    i = line.find_first_not_of(' ', i + key.size() + 3);
+    if (i == std::string::npos) return "";
+
+    if (line[i] == '"') {
+      size_t j = line.find('"', i + 1);
+      return line.substr(i + 1, j - i - 1);
+    }
+
+    size_t j = line.find_first_of(",}", i);
+    return line.substr(i, j - i);
+  }
+
+  std::map<std::string, double> read_baseline(std::istream &is, const std::vector<std::string> &key_fields,
+                                              const std::string &value_field) {
+    std::map<std::string, double> baseline;
+    std::string line;
+
+    while (std::getline(is, line)) {
+      std::string key, value = json_field(line, value_field);
+      if (value.empty()) continue;
+
+      bool complete = true;
+      for (size_t i = 0; i < key_fields.size() && complete; i++) {
+        std::string field = json_field(line, key_fields[i]);
+        complete = !field.empty();
+        key += (i == 0 ? "" : "/") + field;
+      }
+
+      if (complete) baseline.insert({key, std::stod(value)});
+    }
+
+    return baseline;
+  }
+
+  int compare(const std::vector<Measurement> &measurements, const std::map<std::string, double> &baseline,
+              double threshold) {
+    int regressions = 0;
+    std::cout << std::endl << "--- Compared to baseline ---" << std::endl;
+
+    for (const Measurement &m : measurements) {
+      auto it = baseline.find(m.key);
+      if (it == baseline.end()) continue;
+
+      double change = (m.value - it->second) / it->second * 100;
+      bool regressed = change > threshold;
+      regressions += regressed;
+
+      std::cout << std::left << std::setw(20) << m.label << std::right << std::fixed << std::setprecision(1)
+                << std::showpos << std::setw(8) << change << "%" << std::noshowpos << std::defaultfloat
+                << (regressed ? ANSI_RED "  REGRESSION" ANSI_RESET : "") << std::endl;
+    }
+
+    return regressions;
+  }
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+/** Helpers shared by the benchmark suites, which write JSON results with one result per line. */
+namespace bench {
+  /** A measured value, compared against the baseline entry with the same key. */
+  struct Measurement {
+    std::string key;
+    std::string label; // printed in place of the key
+    double value;
+  };
+
+  /** Extract the value of "key": ... from a line of results. Strings are unquoted. */
+  std::string json_field(const std::string &line, const std::string &key);
+
+  /**
+   * Read results, mapping the values of `key_fields` joined by '/' to the value of `value_field`. Lines missing any
+   * field are skipped.
+   */
+  std::map<std::string, double> read_baseline(std::istream &is, const std::vector<std::string> &key_fields,
+                                              const std::string &value_field);
+
+  /** Print the change of each measurement from the baseline, return the number which increased by over `threshold`%. */
+  int compare(const std::vector<Measurement> &measurements, const std::map<std::string, double> &baseline,
+              double threshold);
+}
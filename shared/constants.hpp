@@ -94,6 +94,7 @@ namespace constants {
             reg = 0b011,
             syscall = 0b100,
             datatype = 0b101,
+            arithmetic = 0b110,
             unknown = 0b111,
         };
     }
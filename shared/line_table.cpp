@@ -0,0 +1,95 @@
+#include "line_table.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace line_table {
+  void write(std::ostream &os, const std::vector<std::string> &files, std::vector<Entry> entries) {
+    std::stable_sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b) { return a.pc < b.pc; });
+
+    std::vector<uint32_t> offsets;
+    std::string strings;
+
+    for (const auto &file: files) {
+      offsets.push_back(strings.size());
+      strings += file;
+      strings += '\0';
+    }
+
+    Header header{};
+    std::memcpy(header.magic, magic, sizeof(magic));
+    header.version = version;
+    header.file_count = offsets.size();
+    header.entry_count = entries.size();
+    header.strings_size = strings.size();
+
+    os.write((const char *) &header, sizeof(header));
+    os.write((const char *) offsets.data(), (std::streamsize) (offsets.size() * sizeof(uint32_t)));
+    os.write((const char *) entries.data(), (std::streamsize) (entries.size() * sizeof(Entry)));
+    os.write(strings.data(), (std::streamsize) strings.size());
+  }
+
+  LineTable::~LineTable() {
+    munmap((void *) m_data, m_size);
+  }
+
+  std::unique_ptr<LineTable> LineTable::open(const std::filesystem::path &path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return nullptr;
+
+    struct stat info{};
+    void *data = MAP_FAILED;
+
+    if (fstat(fd, &info) == 0 && info.st_size >= (off_t) sizeof(Header)) {
+      data = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+
+    close(fd);
+    if (data == MAP_FAILED) return nullptr;
+
+    std::unique_ptr<LineTable> table(new LineTable((const uint8_t *) data, info.st_size));
+    const Header &header = table->header();
+
+    // check sections fit, and that every path is terminated
+    uint64_t size = sizeof(Header) + uint64_t(header.file_count) * sizeof(uint32_t) +
+                    uint64_t(header.entry_count) * sizeof(Entry) + header.strings_size;
+
+    if (std::memcmp(header.magic, magic, sizeof(magic)) != 0 || header.version != version || size != table->m_size ||
+        (header.strings_size > 0 && table->m_data[table->m_size - 1] != '\0'))
+      return nullptr;
+
+    auto offsets = (const uint32_t *) (table->m_data + sizeof(Header));
+
+    for (uint32_t i = 0; i < header.file_count; i++) {
+      if (offsets[i] >= header.strings_size) return nullptr;
+    }
+
+    return table;
+  }
+
+  std::span<const Entry> LineTable::entries() const {
+    auto entries = (const Entry *) (m_data + sizeof(Header) + header().file_count * sizeof(uint32_t));
+    return {entries, header().entry_count};
+  }
+
+  const Entry *LineTable::find(uint32_t pc) const {
+    auto entries = this->entries();
+    auto it = std::lower_bound(entries.begin(), entries.end(), pc, [](const Entry &entry, uint32_t pc) {
+      return entry.pc < pc;
+    });
+
+    return it != entries.end() && it->pc == pc ? &*it : nullptr;
+  }
+
+  std::string_view LineTable::file(uint32_t index) const {
+    if (index >= header().file_count) return {};
+
+    auto offsets = (const uint32_t *) (m_data + sizeof(Header));
+    auto strings = (const char *) (m_data + m_size - header().strings_size);
+    return strings + offsets[index];
+  }
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <ostream>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * Binary table mapping $pc to source locations, written by the assembler alongside a binary. All fields are 4-byte
+ * words, so the file may be mapped into memory and used in place. Layout:
+ *   Header | uint32_t file_offsets[file_count] | Entry entries[entry_count] | char strings[strings_size]
+ * Entries are sorted by $pc. Each file offset locates a NUL-terminated path in `strings`.
+ */
+namespace line_table {
+  // first bytes of every line table
+  constexpr char magic[4] = {'E', 'L', 'N', 'T'};
+  constexpr uint32_t version = 2;
+
+  // file index of an absent origin
+  constexpr uint32_t no_file = 0xffffffff;
+
+  struct Header {
+    char magic[4];
+    uint32_t version;
+    uint32_t file_count;
+    uint32_t entry_count;
+    uint32_t strings_size;
+  };
+
+  /** Source of the chunk at `pc`. Line and column numbers are as in the source, or -1 if unknown. */
+  struct Entry {
+    uint32_t pc;
+    uint32_t file; // assembly source
+    int32_t line;
+    uint32_t origin_file; // high-level source, given by a ";@" comment, or no_file
+    int32_t origin_line;
+    int32_t origin_column;
+    uint32_t chunk; // index of the chunk in the order written, which is its line in a reconstruction
+  };
+
+  /** Write a line table with the given files, which entries index into. Entries are sorted by $pc. */
+  void write(std::ostream &os, const std::vector<std::string> &files, std::vector<Entry> entries);
+
+  /** Read-only line table, mapped from a file. */
+  class LineTable {
+    const uint8_t *m_data;
+    size_t m_size;
+
+    LineTable(const uint8_t *data, size_t size) : m_data(data), m_size(size) {}
+
+    [[nodiscard]] const Header &header() const { return *(const Header *) m_data; }
+
+  public:
+    LineTable(const LineTable &) = delete;
+
+    LineTable &operator=(const LineTable &) = delete;
+
+    ~LineTable();
+
+    /** Map the given file, return nullptr if it cannot be read or is not a valid line table. */
+    static std::unique_ptr<LineTable> open(const std::filesystem::path &path);
+
+    [[nodiscard]] std::span<const Entry> entries() const;
+
+    /** Return the entry of the chunk at `pc`, or nullptr if there is none. */
+    [[nodiscard]] const Entry *find(uint32_t pc) const;
+
+    /** Return the path of the given file. */
+    [[nodiscard]] std::string_view file(uint32_t index) const;
+  };
+}
@@ -2,15 +2,16 @@
 
 #include <string>
 #include <filesystem>
+#include <memory>
 #include <utility>
 
 class Location {
-    std::filesystem::path m_path;
+    std::shared_ptr<const std::filesystem::path> m_path; // shared between copies, so locating each line of a file is cheap
     int m_line;
     int m_col;
 
 public:
-    explicit Location(std::filesystem::path path, int line = -1, int col = -1) : m_path(std::move(path)), m_line(line), m_col(col) {}
+    explicit Location(std::filesystem::path path, int line = -1, int col = -1) : m_path(std::make_shared<const std::filesystem::path>(std::move(path))), m_line(line), m_col(col) {}
 
     [[nodiscard]] int line() const { return m_line; }
 
@@ -26,13 +27,13 @@ public:
 
     Location &column(int n) { m_col = n; return *this; }
 
-    [[nodiscard]] const std::filesystem::path &path() const { return m_path; }
+    [[nodiscard]] const std::filesystem::path &path() const { return *m_path; }
 
     [[nodiscard]] Location copy() const { return {*this}; }
 
     std::ostream &print(std::ostream &os, bool canonicalise = false) const {
-        if (canonicalise) os << weakly_canonical(m_path).string();
-        else os << m_path.string();
+        if (canonicalise) os << weakly_canonical(*m_path).string();
+        else os << m_path->string();
 
         if (m_line > -1) {
             os << ":" << m_line;
@@ -5,6 +5,8 @@
 #include <cstdint>
 #include <sstream>
 #include <iomanip>
+#include <functional>
+#include <vector>
 
 /** Trim string from the left. */
 std::string &ltrim(std::string &s, const char *t = " \t\n\r\f\v");
@@ -48,6 +48,15 @@ int parse_arguments(int argc, char** argv, std::unordered_set<uint64_t>& breakpo
         if (!read_file(visualiser::sources::s_source, argc, argv, i, std::ios::in)) {
           return EXIT_FAILURE;
         }
+      } else if (!strcmp(argv[i], "--lines")) {
+        if (++i == argc) {
+          std::cout << argv[i - 1] << ": expected file path\n";
+          return EXIT_FAILURE;
+        }
+        if (!(visualiser::sources::debug_info = line_table::LineTable::open(argv[i]))) {
+          std::cout << "--lines: failed to read line table " << argv[i];
+          return EXIT_FAILURE;
+        }
       } else if (!strcmp(argv[i], "--stdout")) {
         if (!read_file(visualiser::processor::piped_stdout, argc, argv, i, std::ios::out)) {
           return EXIT_FAILURE;
@@ -83,6 +92,11 @@ int parse_arguments(int argc, char** argv, std::unordered_set<uint64_t>& breakpo
       if (!visualiser::processor::source && !read_file(visualiser::processor::source, "--bin", base, std::ios::in)) {
         return EXIT_FAILURE;
       }
+
+      // line table is optional, fall back to parsing debug comments if it is absent
+      if (!visualiser::sources::debug_info) {
+        visualiser::sources::debug_info = line_table::LineTable::open(base + ".lines");
+      }
     } else {
       std::cout << "unexpected argument '" << argv[i] << "'";
       return EXIT_FAILURE;
@@ -20,6 +20,15 @@ void visualiser::processor::init() {
   update_pc(0);
 }
 
+void visualiser::processor::restart() {
+  cpu.fast_reset();
+  cpu.clear_debug_messages();
+  source->stream.clear();
+  source->stream.seekg(0);
+  ::processor::read_binary_file(cpu, source->stream);
+  update_pc(initial_pc);
+}
+
 uint64_t visualiser::processor::restore_pc() {
   cpu.write_pc(initial_pc);
   return initial_pc;
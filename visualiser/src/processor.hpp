@@ -23,6 +23,9 @@ namespace visualiser::processor {
   // reset cpu's $pc to initial value, return the $pc's value
   uint64_t restore_pc();
 
+  /** Reset the processor and reload `source`, as if we had just called init(). */
+  void restart();
+
   // update $pc, but only in state:: -- use CPU's $pc
   void update_pc();
 
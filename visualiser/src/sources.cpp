@@ -6,6 +6,7 @@
 std::unique_ptr<named_fstream> visualiser::sources::edel_source = nullptr;
 std::unique_ptr<named_fstream> visualiser::sources::asm_source = nullptr;
 std::unique_ptr<named_fstream> visualiser::sources::s_source = nullptr;
+std::unique_ptr<line_table::LineTable> visualiser::sources::debug_info = nullptr;
 std::map<uint32_t, visualiser::sources::PCLine> visualiser::sources::pc_to_line = {};
 std::map<std::filesystem::path, visualiser::sources::File> visualiser::sources::files = {};
 Graph<std::pair<std::filesystem::path, int>, visualiser::sources::FileLine*, pair_hash> visualiser::sources::trace;
@@ -166,9 +167,152 @@ static void init_asm_source() {
   }
 }
 
+// convert a 1-based number from the line table, which may be -1 if unknown, to 0-based
+static int from_line_table(int32_t n) {
+  return n < 0 ? -1 : n - 1;
+}
+
+// read .s file for its contents, create binary-to-s links from the line table
+// the reconstruction has one line per chunk, and each entry holds the line of its chunk
+static void init_s_source_from_line_table() {
+  using namespace visualiser::sources;
+
+  // reset file & other state
+  auto &stream = s_source->stream;
+  stream.clear();
+  stream.seekg(std::ios::beg);
+  pc_to_line.clear();
+
+  File* file;
+  {
+    File file_object{s_source->path, Type::Source, {}, true};
+    files.insert({file_object.path, file_object});
+    file = &files.at(file_object.path);
+  }
+  const std::span<const line_table::Entry> entries = debug_info->entries();
+
+  // entries are sorted by $pc, which differs from the order of chunks after a backward .org
+  std::vector<const line_table::Entry*> line_entries(entries.size());
+  for (const line_table::Entry &entry: entries) {
+    if (entry.chunk < line_entries.size()) line_entries[entry.chunk] = &entry;
+  }
+
+  std::string line;
+  size_t idx = 0;
+
+  while (idx < line_entries.size() && line_entries[idx] && std::getline(stream, line)) {
+    const line_table::Entry &entry = *line_entries[idx];
+    std::filesystem::path filepath(debug_info->file(entry.file));
+    int line_no = from_line_table(entry.line);
+
+    // register file as assembly, if need to
+    if (files.find(filepath) == files.end())
+      files.insert({
+        filepath,
+        File{filepath, Type::Assembly, {}, false}
+      });
+
+    // remove debug comment, if any
+    if (size_t i = line.find(';'); i != std::string::npos) line = line.substr(0, i);
+
+    PCLine pc_line{entry.pc, line, (int) idx, Location(filepath, line_no)};
+    if (entry.origin_file != line_table::no_file) {
+      pc_line.lang_origin = Location(std::filesystem::path(debug_info->file(entry.origin_file)),
+                                     from_line_table(entry.origin_line), from_line_table(entry.origin_column));
+    }
+
+    // insert into (both) maps
+    auto it = pc_to_line.insert({entry.pc, std::move(pc_line)}).first;
+    file->lines.push_back(FileLine{
+      file,
+      (int) idx,
+      line,
+      {&it->second}
+    });
+
+    FileLine* file_line = &file->lines.back();
+    auto s_key = std::make_pair(file->path, (int) idx);
+    auto asm_key = std::make_pair(filepath, line_no);
+    trace.insert(s_key, file_line);
+    trace.insert_symmetric(s_key, asm_key);
+
+    idx++;
+  }
+}
+
+// read .asm file for its contents, create links to source file from the $pc entries
+static void init_asm_source_from_line_table() {
+  using namespace visualiser::sources;
+
+  // reset file & other state
+  auto &stream = asm_source->stream;
+  stream.clear();
+  stream.seekg(std::ios::beg);
+
+  File* file;
+  if (auto it = files.find(asm_source->path); it != files.end()) {
+    file = &it->second;
+  } else {
+    File file_object{asm_source->path, Type::Assembly, {}, true};
+    files.insert({file_object.path, file_object});
+    file = &files.at(file_object.path);
+  }
+
+  // group $pc entries by their line in this file, rather than searching for each line
+  std::unordered_map<int, std::vector<PCLine*>> line_to_pcs;
+  for (auto &[pc, entry]: pc_to_line) {
+    if (entry.asm_origin.path() == file->path) {
+      line_to_pcs[entry.asm_origin.line()].push_back(&entry);
+    }
+  }
+
+  file->loaded = true;
+  std::string line;
+  int idx = 0;
+
+  while (std::getline(stream, line)) {
+    // remove debug comment, origins are taken from the line table
+    if (size_t i = line.rfind(";@"); i != std::string::npos) line = line.substr(0, i);
+
+    file->lines.push_back(FileLine{
+        file,
+        idx,
+        line,
+        {}
+    });
+
+    if (auto it = line_to_pcs.find(idx); it != line_to_pcs.end()) {
+      FileLine* file_line = &file->lines.back();
+      file_line->pc_trace = it->second;
+
+      if (const auto &origin = it->second.front()->lang_origin; origin && origin->line() > -1) {
+        // register file as high-level, if need to
+        if (files.find(origin->path()) == files.end())
+          files.insert({
+                           origin->path(),
+                           File{origin->path(), Type::Language, {}, false}
+                       });
+
+        // update trace graph
+        auto asm_key = std::make_pair(file->path, idx);
+        auto lang_key = std::make_pair(origin->path(), origin->line());
+        trace.insert(asm_key, file_line);
+        trace.insert_symmetric(lang_key, asm_key);
+      }
+    }
+
+    idx++;
+  }
+}
+
 void visualiser::sources::init() {
-  init_s_source();
-  init_asm_source();
+  if (debug_info) {
+    init_s_source_from_line_table();
+    init_asm_source_from_line_table();
+  } else {
+    init_s_source();
+    init_asm_source();
+  }
 
   // ensure language file exists
   if (auto it = files.find(edel_source->path); it == files.end()) {
@@ -7,6 +7,7 @@
 #include "messages/list.hpp"
 #include "graph.hpp"
 #include "pair_hash.hpp"
+#include "line_table.hpp"
 
 namespace visualiser::sources {
   enum class Type {
@@ -65,6 +66,7 @@ namespace visualiser::sources {
   extern std::unique_ptr<named_fstream> edel_source; // source edel file
   extern std::unique_ptr<named_fstream> asm_source; // source assembly file (output)
   extern std::unique_ptr<named_fstream> s_source; // source assembly file (reconstruction)
+  extern std::unique_ptr<line_table::LineTable> debug_info; // line table emitted by the assembler (-g), may be NULL
   extern std::map<uint32_t, PCLine> pc_to_line; // map byte offset ($pc) to location
   extern std::map<std::filesystem::path, File> files; // map file paths to contents (used for source storing sources)
 
@@ -298,6 +298,16 @@ namespace events {
     return true;
   }
 
+  // restart the program from the beginning
+  static bool on_restart() {
+    visualiser::processor::restart();
+    state::current_cycle = 0;
+    state::is_running = false;
+    state::debug_lines.clear();
+    update_align_pane_pc();
+    return true;
+  }
+
   // execute *one* cycle
   static bool on_space(visualiser::sources::Type pane) {
     if (!visualiser::processor::pc_line) return false;
@@ -408,6 +418,7 @@ namespace events {
 static bool on_event(ftxui::Event e) {
   if (e == ftxui::Event::h) return events::on_H();
   if (e == ftxui::Event::r) return events::on_reset();
+  if (e == ftxui::Event::Character("R")) return events::on_restart();
   if (e == ftxui::Event::s) return events::on_S();
   return false;
 }